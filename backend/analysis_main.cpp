@@ -0,0 +1,43 @@
+#include "search_engine.h"
+#include "benchmark.h"
+#include "logger.h"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    bool layout = true;
+
+    for(int i = 1; i < argc; i++) {
+        string flag = argv[i];
+        string value = (i + 1 < argc) ? argv[i + 1] : "";
+
+        if(flag == "--warmup") { config.warmup = atoi(value.c_str()); i++; }
+        else if(flag == "--reps") { config.repetitions = atoi(value.c_str()); i++; }
+        else if(flag == "--seed") { config.seed = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10)); i++; }
+        else if(flag == "--flush-cache") config.flush_cache = true;
+        else if(flag == "--perf") PerfCounters::setEnabled(true);
+        else if(flag == "--no-layout") layout = false;
+        else if(flag == "--position") {
+            if(!BenchmarkHarness::parsePosition(value, config.position)) {
+                cerr << "Unknown position " << value << ", use best, average, worst or random" << endl;
+                return 1;
+            }
+            i++;
+        }
+        else {
+            cerr << "Usage: " << argv[0] << " [--warmup N] [--reps N] [--seed N] [--flush-cache]"
+                 << " [--position best|average|worst|random] [--perf] [--no-layout]" << endl;
+            return 1;
+        }
+    }
+
+    Logger::start();
+    LinearSearchEngine::runPerformanceAnalysis(config);
+    if(layout) LinearSearchEngine::runLayoutAnalysis(config);
+    Logger::stop();
+    return 0;
+}
@@ -0,0 +1,255 @@
+#include "benchmark.h"
+#include "search_index.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace std;
+
+// Larger than the last-level cache of the machines we benchmark on.
+static const size_t FLUSH_BYTES = 64 * 1024 * 1024;
+
+BenchmarkHarness::BenchmarkHarness(const BenchmarkConfig& cfg)
+    : config(cfg), rng(cfg.seed), flush_sink(0) {
+    if(config.warmup < 0) config.warmup = 0;
+    if(config.repetitions < 1) config.repetitions = 1;
+    if(config.flush_cache) flush_buffer.assign(FLUSH_BYTES, 1);
+}
+
+size_t BenchmarkHarness::targetIndex(size_t n) {
+    switch(config.position) {
+        case TargetPosition::Best:    return 0;
+        case TargetPosition::Worst:   return n - 1;
+        case TargetPosition::Random:  return uniform_int_distribution<size_t>(0, n - 1)(rng);
+        default:                      return n / 2;
+    }
+}
+
+void BenchmarkHarness::flushCaches() {
+    // Touch one byte per cache line so the catalog is evicted before the next run.
+    char sum = 0;
+    for(size_t i = 0; i < flush_buffer.size(); i += 64) {
+        flush_buffer[i]++;
+        sum += flush_buffer[i];
+    }
+    flush_sink = sum;
+}
+
+BenchmarkStats BenchmarkHarness::run(const string& algorithm, int size) {
+    auto videos = LinearSearchEngine::generateVideoData(size, config.seed);
+    auto keys = LinearSearchEngine::generateVideoKeys(size, config.seed);
+    return run(algorithm, videos, keys);
+}
+
+BenchmarkStats BenchmarkHarness::run(const string& algorithm, const vector<string>& videos,
+                                     const VideoKeyCatalog& keys) {
+    size_t n = videos.size();
+    string position = positionName(config.position);
+
+    if(n == 0 || (algorithm == "recursive" && n > static_cast<size_t>(LinearSearchEngine::maxRecursiveSize()))) {
+        return summarize(algorithm, static_cast<int>(n), position, {}, 0);
+    }
+
+    function<SearchResult(size_t)> search;
+    unique_ptr<SearchIndex> index;
+
+    if(algorithm == "iterative") {
+        search = [&](size_t i) { return LinearSearchEngine::linearSearchIterative(videos, videos[i]); };
+    }
+    else if(algorithm == "recursive") {
+        search = [&](size_t i) { return LinearSearchEngine::linearSearchRecursive(videos, videos[i]); };
+    }
+    else if(algorithm == "divide") {
+        search = [&](size_t i) { return LinearSearchEngine::linearSearchDivideConquer(videos, videos[i]); };
+    }
+    else if(algorithm == "compact") {
+        search = [&](size_t i) { return LinearSearchEngine::linearSearchIterative(keys, keys.keys[i]); };
+    }
+    else if(algorithm == "simd") {
+        search = [&](size_t i) { return LinearSearchEngine::linearSearchSimd(keys, keys.keys[i]); };
+    }
+    else if(algorithm == "parallel") {
+        search = [&](size_t i) { return LinearSearchEngine::linearSearchParallel(videos, videos[i]); };
+    }
+    else if((index = makeSearchIndex(algorithm))) {
+        index->build(keys);
+        search = [&](size_t i) { return index->search(keys.keys[i]); };
+    }
+    else {
+        throw invalid_argument("Unknown algorithm: " + algorithm);
+    }
+
+    for(int w = 0; w < config.warmup; w++) {
+        search(targetIndex(n));
+    }
+
+    vector<long long> samples;
+    vector<PerfCounterValues> counters;
+    samples.reserve(config.repetitions);
+    counters.reserve(config.repetitions);
+    double total_comparisons = 0;
+
+    for(int r = 0; r < config.repetitions; r++) {
+        size_t target = targetIndex(n);
+        if(config.flush_cache) flushCaches();
+
+        SearchResult result = search(target);
+        samples.push_back(result.execution_time_ns);
+        counters.push_back(result.counters);
+        total_comparisons += result.comparisons;
+    }
+
+    return summarize(algorithm, static_cast<int>(n), position, move(samples),
+                     total_comparisons / config.repetitions, counters);
+}
+
+// Mean of one counter over the runs that have it; -1 if none do.
+static double meanCounter(const vector<PerfCounterValues>& counters,
+                          long long PerfCounterValues::*field) {
+    double sum = 0;
+    int count = 0;
+    for(const auto& c : counters) {
+        if(!c.available || c.*field < 0) continue;
+        sum += c.*field;
+        count++;
+    }
+    return count > 0 ? sum / count : -1;
+}
+
+BenchmarkStats BenchmarkHarness::summarize(const string& algorithm, int size, const string& position,
+                                           vector<long long> samples_ns, double mean_comparisons,
+                                           const vector<PerfCounterValues>& counters) {
+    BenchmarkStats stats;
+    stats.algorithm = algorithm;
+    stats.size = size;
+    stats.position = position;
+    stats.repetitions = static_cast<int>(samples_ns.size());
+    stats.mean_comparisons = mean_comparisons;
+    stats.cycles = meanCounter(counters, &PerfCounterValues::cycles);
+    stats.instructions = meanCounter(counters, &PerfCounterValues::instructions);
+    stats.l1d_misses = meanCounter(counters, &PerfCounterValues::l1d_misses);
+    stats.llc_misses = meanCounter(counters, &PerfCounterValues::llc_misses);
+    stats.branch_misses = meanCounter(counters, &PerfCounterValues::branch_misses);
+
+    if(samples_ns.empty()) {
+        stats.min_ns = stats.median_ns = stats.p95_ns = stats.p99_ns = 0;
+        stats.mean_ns = stats.stddev_ns = stats.ns_per_element = 0;
+        return stats;
+    }
+
+    sort(samples_ns.begin(), samples_ns.end());
+    size_t count = samples_ns.size();
+
+    // Nearest-rank percentiles.
+    auto percentile = [&](double p) {
+        size_t rank = static_cast<size_t>(ceil(p / 100.0 * count));
+        return static_cast<double>(samples_ns[max<size_t>(rank, 1) - 1]);
+    };
+
+    double sum = 0;
+    for(long long s : samples_ns) sum += s;
+    double mean = sum / count;
+
+    double squares = 0;
+    for(long long s : samples_ns) squares += (s - mean) * (s - mean);
+
+    stats.min_ns = static_cast<double>(samples_ns.front());
+    stats.median_ns = (count % 2 == 1)
+        ? samples_ns[count / 2]
+        : (samples_ns[count / 2 - 1] + samples_ns[count / 2]) / 2.0;
+    stats.p95_ns = percentile(95);
+    stats.p99_ns = percentile(99);
+    stats.mean_ns = mean;
+    stats.stddev_ns = count > 1 ? sqrt(squares / (count - 1)) : 0;
+    stats.ns_per_element = stats.median_ns / size;
+    return stats;
+}
+
+void BenchmarkHarness::writeCsv(const string& path, const vector<BenchmarkStats>& stats) {
+    ofstream csv_file(path);
+    csv_file << fixed << setprecision(3);
+    csv_file << "Algorithm,Size,Position,Repetitions,Min_ns,Median_ns,P95_ns,P99_ns,"
+                "Mean_ns,Stddev_ns,Ns_per_Element,Mean_Comparisons,"
+                "Cycles,Instructions,L1D_Misses,LLC_Misses,Branch_Misses\n";
+
+    for(const auto& s : stats) {
+        csv_file << s.algorithm << ","
+                << s.size << ","
+                << s.position << ","
+                << s.repetitions << ","
+                << s.min_ns << ","
+                << s.median_ns << ","
+                << s.p95_ns << ","
+                << s.p99_ns << ","
+                << s.mean_ns << ","
+                << s.stddev_ns << ","
+                << s.ns_per_element << ","
+                << s.mean_comparisons << ","
+                << s.cycles << ","
+                << s.instructions << ","
+                << s.l1d_misses << ","
+                << s.llc_misses << ","
+                << s.branch_misses << '\n';
+    }
+}
+
+void BenchmarkHarness::writeJson(const string& path, const vector<BenchmarkStats>& stats,
+                                 const BenchmarkConfig& config) {
+    ofstream json_file(path);
+    json_file << fixed << setprecision(3);
+    json_file << "{\n";
+    json_file << "  \"config\": {"
+              << "\"warmup\": " << config.warmup << ", "
+              << "\"repetitions\": " << config.repetitions << ", "
+              << "\"flush_cache\": " << (config.flush_cache ? "true" : "false") << ", "
+              << "\"position\": \"" << positionName(config.position) << "\", "
+              << "\"seed\": " << config.seed << ", "
+              << "\"perf_counters\": \"" << PerfCounters::status() << "\"},\n";
+    json_file << "  \"results\": [\n";
+
+    for(size_t i = 0; i < stats.size(); i++) {
+        const auto& s = stats[i];
+        json_file << "    {"
+                  << "\"algorithm\": \"" << s.algorithm << "\", "
+                  << "\"size\": " << s.size << ", "
+                  << "\"position\": \"" << s.position << "\", "
+                  << "\"repetitions\": " << s.repetitions << ", "
+                  << "\"min_ns\": " << s.min_ns << ", "
+                  << "\"median_ns\": " << s.median_ns << ", "
+                  << "\"p95_ns\": " << s.p95_ns << ", "
+                  << "\"p99_ns\": " << s.p99_ns << ", "
+                  << "\"mean_ns\": " << s.mean_ns << ", "
+                  << "\"stddev_ns\": " << s.stddev_ns << ", "
+                  << "\"ns_per_element\": " << s.ns_per_element << ", "
+                  << "\"mean_comparisons\": " << s.mean_comparisons << ", "
+                  << "\"cycles\": " << s.cycles << ", "
+                  << "\"instructions\": " << s.instructions << ", "
+                  << "\"l1d_misses\": " << s.l1d_misses << ", "
+                  << "\"llc_misses\": " << s.llc_misses << ", "
+                  << "\"branch_misses\": " << s.branch_misses << "}"
+                  << (i + 1 < stats.size() ? "," : "") << "\n";
+    }
+
+    json_file << "  ]\n}\n";
+}
+
+const char* BenchmarkHarness::positionName(TargetPosition position) {
+    switch(position) {
+        case TargetPosition::Best:    return "best";
+        case TargetPosition::Worst:   return "worst";
+        case TargetPosition::Random:  return "random";
+        default:                      return "average";
+    }
+}
+
+bool BenchmarkHarness::parsePosition(const string& name, TargetPosition& position) {
+    if(name == "best") position = TargetPosition::Best;
+    else if(name == "average") position = TargetPosition::Average;
+    else if(name == "worst") position = TargetPosition::Worst;
+    else if(name == "random") position = TargetPosition::Random;
+    else return false;
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "search_engine.h"
+#include <random>
+
+// Repeated, warmed-up timing of the search algorithms. Every run() times
+// config.repetitions searches after config.warmup untimed ones and reduces
+// the samples to BenchmarkStats.
+class BenchmarkHarness {
+public:
+    explicit BenchmarkHarness(const BenchmarkConfig& config);
+
+    // algorithm: iterative, recursive, divide, compact, simd, parallel, hash,
+    // binary or eytzinger. videos and keys must hold the same catalog in the same order.
+    BenchmarkStats run(const std::string& algorithm, const std::vector<std::string>& videos,
+                       const VideoKeyCatalog& keys);
+    BenchmarkStats run(const std::string& algorithm, int size);
+
+    static BenchmarkStats summarize(const std::string& algorithm, int size,
+                                    const std::string& position,
+                                    std::vector<long long> samples_ns, double mean_comparisons,
+                                    const std::vector<PerfCounterValues>& counters = {});
+
+    static void writeCsv(const std::string& path, const std::vector<BenchmarkStats>& stats);
+    static void writeJson(const std::string& path, const std::vector<BenchmarkStats>& stats,
+                          const BenchmarkConfig& config);
+
+    static const char* positionName(TargetPosition position);
+    static bool parsePosition(const std::string& name, TargetPosition& position);
+
+private:
+    size_t targetIndex(size_t n);
+    void flushCaches();
+
+    BenchmarkConfig config;
+    std::mt19937 rng;
+    std::vector<char> flush_buffer;
+    volatile char flush_sink;
+};
+
+#endif
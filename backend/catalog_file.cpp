@@ -0,0 +1,159 @@
+#include "catalog_file.h"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const uint64_t SECTION_ALIGN = 64;
+
+static uint64_t alignSection(uint64_t offset) {
+    return (offset + SECTION_ALIGN - 1) & ~(SECTION_ALIGN - 1);
+}
+
+void writeCatalogFile(const string& path, const vector<string>& ids) {
+    vector<uint32_t> keys(ids.size());
+    bool has_keys = true;
+    for(size_t i = 0; i < ids.size() && has_keys; i++) {
+        has_keys = VideoKeyCatalog::parseVideoId(ids[i], keys[i]);
+    }
+
+    vector<uint64_t> offsets(ids.size() + 1);
+    for(size_t i = 0; i < ids.size(); i++) {
+        offsets[i + 1] = offsets[i] + ids[i].size();
+    }
+
+    CatalogFileHeader header{};
+    memcpy(header.magic, CATALOG_MAGIC, sizeof(header.magic));
+    header.version = CATALOG_VERSION;
+    header.flags = has_keys ? CATALOG_HAS_KEYS : 0;
+    header.count = ids.size();
+
+    uint64_t pos = sizeof(header);
+    if(has_keys) {
+        header.keys_offset = alignSection(pos);
+        pos = header.keys_offset + keys.size() * sizeof(uint32_t);
+    }
+    header.offsets_offset = alignSection(pos);
+    pos = header.offsets_offset + offsets.size() * sizeof(uint64_t);
+    header.strings_offset = alignSection(pos);
+    header.strings_bytes = offsets.back();
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if(!out) throw runtime_error("Cannot create " + path);
+
+    uint64_t written = 0;
+    auto pad_to = [&](uint64_t offset) {
+        static const char zeros[SECTION_ALIGN] = {};
+        out.write(zeros, static_cast<streamsize>(offset - written));
+        written = offset;
+    };
+    auto put = [&](const void* data, uint64_t bytes) {
+        out.write(static_cast<const char*>(data), static_cast<streamsize>(bytes));
+        written += bytes;
+    };
+
+    put(&header, sizeof(header));
+    if(has_keys) {
+        pad_to(header.keys_offset);
+        put(keys.data(), keys.size() * sizeof(uint32_t));
+    }
+    pad_to(header.offsets_offset);
+    put(offsets.data(), offsets.size() * sizeof(uint64_t));
+    pad_to(header.strings_offset);
+    for(const auto& id : ids) put(id.data(), id.size());
+
+    out.flush();
+    if(!out) throw runtime_error("Failed writing " + path);
+}
+
+MappedCatalog::MappedCatalog(const string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) throw runtime_error("Cannot open " + path + ": " + strerror(errno));
+
+    struct stat st;
+    if(fstat(fd, &st) < 0 || st.st_size < static_cast<off_t>(sizeof(CatalogFileHeader))) {
+        close(fd);
+        throw runtime_error(path + " is too small to be a catalog");
+    }
+    length = static_cast<size_t>(st.st_size);
+
+    base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   // the mapping keeps the file referenced
+    if(base == MAP_FAILED) {
+        base = nullptr;
+        throw runtime_error("Cannot map " + path + ": " + strerror(errno));
+    }
+    // Linear scans read front to back; let the kernel read ahead aggressively.
+    madvise(base, length, MADV_SEQUENTIAL);
+
+    const char* bytes = static_cast<const char*>(base);
+    CatalogFileHeader header;
+    memcpy(&header, bytes, sizeof(header));
+
+    auto fail = [&](const string& reason) {
+        release();
+        throw runtime_error(path + ": " + reason);
+    };
+    // True when [offset, offset + count * width) lies inside the file.
+    auto fits = [&](uint64_t offset, uint64_t n, uint64_t width) {
+        return offset % SECTION_ALIGN == 0 && offset <= length && n <= (length - offset) / width;
+    };
+
+    if(memcmp(header.magic, CATALOG_MAGIC, sizeof(header.magic)) != 0) fail("not a catalog file");
+    if(header.version != CATALOG_VERSION) fail("unsupported catalog version " + to_string(header.version));
+    if(header.count >= static_cast<uint64_t>(INT32_MAX)) fail("too many entries");
+    if(!fits(header.offsets_offset, header.count + 1, sizeof(uint64_t))) fail("offsets table out of range");
+    if(!fits(header.strings_offset, header.strings_bytes, 1)) fail("string section out of range");
+
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(bytes + header.offsets_offset);
+    // One pass over the offsets so a corrupt file cannot send a search outside the mapping.
+    if(offsets[0] != 0 || offsets[header.count] != header.strings_bytes) fail("offsets table corrupt");
+    for(uint64_t i = 0; i < header.count; i++) {
+        if(offsets[i + 1] < offsets[i]) fail("offsets table corrupt");
+    }
+
+    count = static_cast<size_t>(header.count);
+    id_view = StringTableView{offsets, bytes + header.strings_offset, count};
+
+    if(header.flags & CATALOG_HAS_KEYS) {
+        if(!fits(header.keys_offset, header.count, sizeof(uint32_t))) fail("key section out of range");
+        key_view = VideoKeyView{reinterpret_cast<const uint32_t*>(bytes + header.keys_offset), count};
+    }
+}
+
+MappedCatalog::~MappedCatalog() {
+    release();
+}
+
+MappedCatalog::MappedCatalog(MappedCatalog&& other) noexcept {
+    *this = move(other);
+}
+
+MappedCatalog& MappedCatalog::operator=(MappedCatalog&& other) noexcept {
+    if(this != &other) {
+        release();
+        base = other.base;
+        length = other.length;
+        count = other.count;
+        key_view = other.key_view;
+        id_view = other.id_view;
+        other.base = nullptr;
+        other.length = 0;
+        other.count = 0;
+        other.key_view = VideoKeyView();
+        other.id_view = StringTableView();
+    }
+    return *this;
+}
+
+void MappedCatalog::release() {
+    if(base) munmap(base, length);
+    base = nullptr;
+    length = 0;
+}
@@ -0,0 +1,68 @@
+#ifndef CATALOG_FILE_H
+#define CATALOG_FILE_H
+
+#include "search_engine.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// On-disk catalog, native (little-endian) byte order:
+//
+//   CatalogFileHeader                       64 bytes
+//   keys      uint32_t[count]               only with CATALOG_HAS_KEYS
+//   offsets   uint64_t[count + 1]           into the string section
+//   strings   char[strings_bytes]           IDs back to back, no terminators
+//
+// Every section starts on a 64-byte boundary, so once the file is mapped the
+// sections are used in place as VideoKeyView / StringTableView.
+constexpr char CATALOG_MAGIC[8] = {'V', 'I', 'D', 'C', 'A', 'T', '\0', '\0'};
+constexpr uint32_t CATALOG_VERSION = 1;
+constexpr uint32_t CATALOG_HAS_KEYS = 1;   // every ID is a "VID_<n>_YouTube" ID
+
+struct CatalogFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t count;
+    uint64_t keys_offset;       // 0 without CATALOG_HAS_KEYS
+    uint64_t offsets_offset;
+    uint64_t strings_offset;
+    uint64_t strings_bytes;
+    uint64_t reserved;
+};
+static_assert(sizeof(CatalogFileHeader) == 64, "catalog header must stay 64 bytes");
+
+// Writes ids in the format above; throws runtime_error when the file cannot be written.
+void writeCatalogFile(const std::string& path, const std::vector<std::string>& ids);
+
+// A catalog file mapped read-only. Nothing is copied at open time: pages are
+// faulted in by the searches that touch them. Throws runtime_error when the
+// file cannot be mapped or fails validation.
+class MappedCatalog {
+public:
+    explicit MappedCatalog(const std::string& path);
+    ~MappedCatalog();
+
+    MappedCatalog(const MappedCatalog&) = delete;
+    MappedCatalog& operator=(const MappedCatalog&) = delete;
+    MappedCatalog(MappedCatalog&& other) noexcept;
+    MappedCatalog& operator=(MappedCatalog&& other) noexcept;
+
+    size_t size() const { return count; }
+    size_t fileBytes() const { return length; }
+    bool hasKeys() const { return key_view.keys != nullptr; }
+
+    VideoKeyView keys() const { return key_view; }      // empty without CATALOG_HAS_KEYS
+    StringTableView ids() const { return id_view; }
+
+private:
+    void release();
+
+    void* base = nullptr;
+    size_t length = 0;
+    size_t count = 0;
+    VideoKeyView key_view;
+    StringTableView id_view;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "catalog_file.h"
+#include "search_engine.h"
+#include "simd_kernels.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+
+// One ID per line, or the first column of a CSV file. Blank lines and lines
+// starting with '#' are skipped, surrounding whitespace and quotes removed.
+static vector<string> readIdList(const string& path, bool skip_header) {
+    ifstream in(path);
+    if(!in) throw runtime_error("Cannot open " + path);
+
+    vector<string> ids;
+    string line;
+    bool first = true;
+    while(getline(in, line)) {
+        if(first && skip_header) {
+            first = false;
+            continue;
+        }
+        first = false;
+
+        string field = line.substr(0, line.find(','));
+        size_t begin = field.find_first_not_of(" \t\r\"");
+        if(begin == string::npos || field[begin] == '#') continue;
+        size_t end = field.find_last_not_of(" \t\r\"");
+        ids.push_back(field.substr(begin, end - begin + 1));
+    }
+    return ids;
+}
+
+static void printUsage(const char* prog) {
+    cerr << "Usage:" << endl
+         << "  " << prog << " convert <ids.txt|ids.csv> <out.vcat> [--skip-header]" << endl
+         << "  " << prog << " generate <n> <seed> <out.vcat>" << endl
+         << "  " << prog << " search <catalog.vcat> <id>" << endl;
+}
+
+static void printResult(const SearchResult& r) {
+    cout << "  " << r.algorithm << ": "
+         << (r.found ? "found at " + to_string(r.index) : string("not found"))
+         << ", " << r.comparisons << " comparisons, " << r.execution_time_ns << " ns" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    string command = argv[1];
+
+    try {
+        if(command == "convert" && (argc == 4 || argc == 5)) {
+            bool skip_header = (argc == 5 && string(argv[4]) == "--skip-header");
+            vector<string> ids = readIdList(argv[2], skip_header);
+            writeCatalogFile(argv[3], ids);
+            MappedCatalog catalog(argv[3]);
+            cout << "Wrote " << catalog.size() << " IDs to " << argv[3] << " (" << catalog.fileBytes()
+                 << " bytes, " << (catalog.hasKeys() ? "with" : "without") << " key section)" << endl;
+        }
+        else if(command == "generate" && argc == 5) {
+            int n = atoi(argv[2]);
+            uint32_t seed = static_cast<uint32_t>(strtoul(argv[3], nullptr, 10));
+            writeCatalogFile(argv[4], LinearSearchEngine::generateVideoData(n, seed));
+            MappedCatalog catalog(argv[4]);
+            cout << "Wrote " << catalog.size() << " IDs to " << argv[4] << " (" << catalog.fileBytes()
+                 << " bytes)" << endl;
+        }
+        else if(command == "search" && argc == 4) {
+            MappedCatalog catalog(argv[2]);
+            string target = argv[3];
+            cout << "Searching " << catalog.size() << " IDs in " << argv[2] << " for " << target << endl;
+            printResult(LinearSearchEngine::linearSearchIterative(catalog.ids(), target));
+            if(catalog.hasKeys()) {
+                printResult(LinearSearchEngine::linearSearchIterative(catalog.keys(), target));
+                printResult(LinearSearchEngine::linearSearchSimd(catalog.keys(), target));
+                cout << "  (SIMD level: " << simdLevelName(detectSimdLevel()) << ")" << endl;
+            }
+        }
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    catch(const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
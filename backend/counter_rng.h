@@ -0,0 +1,70 @@
+#ifndef COUNTER_RNG_H
+#define COUNTER_RNG_H
+
+#include <cstdint>
+
+// SplitMix64 (Steele, Lea and Flood). Its k-th output is a pure function of
+// (seed, k), so any element of a stream can be drawn directly and parallel
+// workers produce the same numbers as one thread would.
+struct SplitMix64 {
+    static constexpr uint64_t GAMMA = 0x9E3779B97F4A7C15ULL;
+
+    uint64_t state;
+
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t next() { return mix(state += GAMMA); }
+    uint64_t at(uint64_t k) const { return mix(state + (k + 1) * GAMMA); }
+};
+
+// Pseudo-random bijection on [0, n) keyed by a seed: a balanced Feistel
+// network over the smallest even number of bits that covers n, with cycle
+// walking for values that land outside the range (fewer than four steps on
+// average). permute(i) needs no state, so a shuffled array can be filled in
+// any order by any number of threads and comes out identical.
+class RandomPermutation {
+public:
+    static constexpr int ROUNDS = 4;
+
+    RandomPermutation(uint64_t n, uint64_t seed) : n(n), half_bits(1) {
+        while(half_bits < 32 && (1ULL << (2 * half_bits)) < n) half_bits++;
+        half_mask = (1ULL << half_bits) - 1;
+        SplitMix64 keys(seed);
+        for(int r = 0; r < ROUNDS; r++) round_keys[r] = keys.next();
+    }
+
+    uint64_t size() const { return n; }
+
+    uint64_t permute(uint64_t i) const {
+        uint64_t x = i;
+        do {
+            x = encrypt(x);
+        } while(x >= n);
+        return x;
+    }
+
+private:
+    uint64_t encrypt(uint64_t x) const {
+        uint64_t left = x >> half_bits;
+        uint64_t right = x & half_mask;
+        for(int r = 0; r < ROUNDS; r++) {
+            uint64_t next = left ^ (SplitMix64::mix(right ^ round_keys[r]) & half_mask);
+            left = right;
+            right = next;
+        }
+        return (left << half_bits) | right;
+    }
+
+    uint64_t n;
+    int half_bits;
+    uint64_t half_mask;
+    uint64_t round_keys[ROUNDS];
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "dataset_cache.h"
+
+using namespace std;
+
+// Returns the layout in slot, building it with make() if this is the first
+// request for it. lock holds the dataset's layout mutex and is released
+// before building or waiting; later requests wait for the first build. A
+// failed build empties the slot again so the next request retries.
+template<typename T, typename Make>
+static shared_ptr<const T> buildOnce(unique_lock<mutex>& lock, shared_future<shared_ptr<const T>>& slot,
+                                     size_t* built_bytes, Make make) {
+    if(slot.valid()) {
+        shared_future<shared_ptr<const T>> pending = slot;
+        lock.unlock();
+        return pending.get();
+    }
+
+    promise<shared_ptr<const T>> building;
+    slot = building.get_future().share();
+    lock.unlock();
+
+    shared_ptr<const T> built;
+    try {
+        built = make();
+    } catch(...) {
+        lock.lock();
+        slot = shared_future<shared_ptr<const T>>();
+        lock.unlock();
+        building.set_exception(current_exception());
+        throw;
+    }
+    building.set_value(built);
+    if(built_bytes) *built_bytes = built->memoryBytes();
+    return built;
+}
+
+shared_ptr<const SearchIndex> Dataset::index(const string& algorithm, size_t* built_bytes) const {
+    unique_lock<mutex> lock(layout_mutex);
+    auto it = indexes.find(algorithm);
+    if(it == indexes.end()) {
+        if(!makeSearchIndex(algorithm)) return nullptr;
+        it = indexes.emplace(algorithm, shared_future<shared_ptr<const SearchIndex>>()).first;
+    }
+    return buildOnce(lock, it->second, built_bytes, [&]() {
+        shared_ptr<SearchIndex> index = makeSearchIndex(algorithm);
+        index->build(keys);
+        return shared_ptr<const SearchIndex>(move(index));
+    });
+}
+
+shared_ptr<const FlatStringTable> Dataset::flat(size_t* built_bytes) const {
+    unique_lock<mutex> lock(layout_mutex);
+    return buildOnce(lock, flat_table, built_bytes, [&]() {
+        return make_shared<const FlatStringTable>(FlatStringTable::fromStrings(videos));
+    });
+}
+
+DatasetCache::DatasetCache(size_t budget_bytes)
+    : budget(budget_bytes), used(0), hits(0), misses(0), evictions(0) {}
+
+DatasetCache::DatasetPtr DatasetCache::build(int size, uint32_t seed, CatalogKind kind) {
+    auto dataset = make_shared<Dataset>();
+    dataset->size = size;
+    dataset->seed = seed;
+    dataset->kind = kind;
+    if(kind == CatalogKind::Titles) {
+        dataset->videos = LinearSearchEngine::generateVideoTitles(size, seed);
+    } else {
+        dataset->videos = LinearSearchEngine::generateVideoData(size, seed);
+        dataset->keys = LinearSearchEngine::generateVideoKeys(size, seed);
+    }
+    dataset->bytes = LinearSearchEngine::stringCatalogBytes(dataset->videos) + dataset->keys.memoryBytes();
+    return dataset;
+}
+
+DatasetCache::DatasetPtr DatasetCache::get(int size, uint32_t seed, CatalogKind kind) {
+    Key key(size, seed, kind);
+    promise<DatasetPtr> building;
+
+    unique_lock<mutex> lock(cache_mutex);
+    auto it = entries.find(key);
+    if(it != entries.end()) {
+        hits++;
+        lru.splice(lru.begin(), lru, it->second.lru_position);
+        shared_future<DatasetPtr> pending = it->second.dataset;
+        lock.unlock();
+        return pending.get();   // waits if another request is still building it
+    }
+
+    misses++;
+    lru.push_front(key);
+    entries[key] = Entry{building.get_future().share(), lru.begin(), 0};
+    lock.unlock();
+
+    DatasetPtr dataset;
+    try {
+        dataset = build(size, seed, kind);
+    } catch(...) {
+        lock.lock();
+        it = entries.find(key);
+        lru.erase(it->second.lru_position);
+        entries.erase(it);
+        building.set_exception(current_exception());
+        throw;
+    }
+    building.set_value(dataset);
+
+    lock.lock();
+    it = entries.find(key);
+    if(it != entries.end()) {
+        it->second.bytes = dataset->bytes;
+        used += dataset->bytes;
+        evictOverBudget();
+    }
+    return dataset;
+}
+
+shared_ptr<const FlatStringTable> DatasetCache::flat(const DatasetPtr& dataset) {
+    size_t built = 0;
+    auto table = dataset->flat(&built);
+    if(built) charge(*dataset, built);
+    return table;
+}
+
+shared_ptr<const SearchIndex> DatasetCache::index(const DatasetPtr& dataset, const string& algorithm) {
+    size_t built = 0;
+    auto index = dataset->index(algorithm, &built);
+    if(built) charge(*dataset, built);
+    return index;
+}
+
+// Adds a lazily built layout to the dataset's entry. A dataset that was
+// evicted meanwhile, or replaced by a rebuild of the same key, is no longer
+// counted against the budget and is not charged.
+void DatasetCache::charge(const Dataset& dataset, size_t bytes) {
+    lock_guard<mutex> lock(cache_mutex);
+    auto it = entries.find(Key(dataset.size, dataset.seed, dataset.kind));
+    if(it == entries.end() || it->second.bytes == 0 || it->second.dataset.get().get() != &dataset) return;
+
+    it->second.bytes += bytes;
+    used += bytes;
+    evictOverBudget();
+}
+
+void DatasetCache::evictOverBudget() {
+    auto position = lru.end();
+    while(used > budget && position != lru.begin()) {
+        --position;
+        auto it = entries.find(*position);
+        if(it->second.bytes == 0) continue;     // still being built
+
+        used -= it->second.bytes;
+        entries.erase(it);
+        position = lru.erase(position);
+        evictions++;
+    }
+}
+
+DatasetCacheStats DatasetCache::stats() const {
+    lock_guard<mutex> lock(cache_mutex);
+    DatasetCacheStats s;
+    s.hits = hits.load();
+    s.misses = misses.load();
+    s.evictions = evictions.load();
+    s.entries = static_cast<long long>(entries.size());
+    s.bytes = static_cast<long long>(used);
+    s.budget_bytes = static_cast<long long>(budget);
+    return s;
+}
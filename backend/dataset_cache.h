@@ -0,0 +1,95 @@
+#ifndef DATASET_CACHE_H
+#define DATASET_CACHE_H
+
+#include "search_engine.h"
+#include "search_index.h"
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <atomic>
+#include <tuple>
+
+enum class CatalogKind {
+    Ids,        // "VID_<n>_YouTube", also held as compact keys
+    Titles      // variable-length titles, no numeric key
+};
+
+// One generated catalog in every layout it supports, in the same shuffled
+// order. Shared between requests and never modified after it is built;
+// the flat string table and the lookup indexes over the keys are built on
+// first use and then shared as well. Each layout is built once, outside the
+// lock, so different layouts build in parallel. Title catalogs leave keys
+// empty.
+struct Dataset {
+    int size;
+    uint32_t seed;
+    CatalogKind kind;
+    std::vector<std::string> videos;
+    VideoKeyCatalog keys;
+    size_t bytes;       // videos and keys; lazily built layouts are charged by DatasetCache
+
+    // built_bytes, if given, is set to the layout's size when this call built it.
+    std::shared_ptr<const FlatStringTable> flat(size_t* built_bytes = nullptr) const;
+
+    // nullptr when algorithm does not name an index (see makeSearchIndex).
+    std::shared_ptr<const SearchIndex> index(const std::string& algorithm, size_t* built_bytes = nullptr) const;
+
+private:
+    mutable std::mutex layout_mutex;
+    mutable std::map<std::string, std::shared_future<std::shared_ptr<const SearchIndex>>> indexes;
+    mutable std::shared_future<std::shared_ptr<const FlatStringTable>> flat_table;
+};
+
+struct DatasetCacheStats {
+    long long hits;
+    long long misses;
+    long long evictions;
+    long long entries;
+    long long bytes;
+    long long budget_bytes;
+};
+
+// Thread-safe LRU cache of datasets keyed by (size, seed, kind). Entries are
+// evicted once their total size exceeds the budget; readers that still hold
+// a dataset keep it alive. Concurrent misses for the same key build it once.
+// Layouts built later through flat() and index() are added to their entry's
+// size, which can evict it or older entries.
+class DatasetCache {
+public:
+    using DatasetPtr = std::shared_ptr<const Dataset>;
+
+    explicit DatasetCache(size_t budget_bytes);
+
+    DatasetPtr get(int size, uint32_t seed, CatalogKind kind = CatalogKind::Ids);
+    std::shared_ptr<const FlatStringTable> flat(const DatasetPtr& dataset);
+    std::shared_ptr<const SearchIndex> index(const DatasetPtr& dataset, const std::string& algorithm);
+    DatasetCacheStats stats() const;
+
+    static DatasetPtr build(int size, uint32_t seed, CatalogKind kind = CatalogKind::Ids);
+
+private:
+    using Key = std::tuple<int, uint32_t, CatalogKind>;
+
+    struct Entry {
+        std::shared_future<DatasetPtr> dataset;
+        std::list<Key>::iterator lru_position;
+        size_t bytes;       // 0 while still being built
+    };
+
+    void charge(const Dataset& dataset, size_t bytes);
+    void evictOverBudget();
+
+    mutable std::mutex cache_mutex;
+    std::map<Key, Entry> entries;
+    std::list<Key> lru;     // most recently used first
+    size_t budget;
+    size_t used;
+
+    std::atomic<long long> hits;
+    std::atomic<long long> misses;
+    std::atomic<long long> evictions;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "dataset_cache.h"
+#include "test_check.h"
+#include <thread>
+
+using namespace std;
+
+// A lazily built layout is added to its entry's size, once.
+static void testLayoutsAreCharged() {
+    DatasetCache cache(64 * 1024 * 1024);
+    auto dataset = cache.get(20000, 1);
+    CHECK(cache.stats().bytes == static_cast<long long>(dataset->bytes));
+
+    auto index = cache.index(dataset, "hash");
+    CHECK(index != nullptr);
+    long long with_index = static_cast<long long>(dataset->bytes + index->memoryBytes());
+    CHECK(cache.stats().bytes == with_index);
+    CHECK(cache.index(dataset, "hash") == index);
+    CHECK(cache.stats().bytes == with_index);
+
+    CHECK(cache.index(dataset, "iterative") == nullptr);
+    CHECK(cache.stats().bytes == with_index);
+
+    auto flat = cache.flat(dataset);
+    CHECK(cache.stats().bytes == with_index + static_cast<long long>(flat->memoryBytes()));
+}
+
+// Concurrent first requests for one layout build it once and share it.
+static void testLayoutBuiltOnce() {
+    DatasetCache cache(64 * 1024 * 1024);
+    auto dataset = cache.get(50000, 2);
+    const int threads = 8;
+    vector<shared_ptr<const FlatStringTable>> tables(threads);
+    vector<shared_ptr<const SearchIndex>> indexes(threads);
+    vector<thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            tables[t] = cache.flat(dataset);
+            indexes[t] = cache.index(dataset, t % 2 ? "binary" : "eytzinger");
+        });
+    }
+    for(auto& w : workers) w.join();
+
+    for(int t = 0; t < threads; t++) {
+        CHECK(tables[t] == tables[0]);
+        CHECK(indexes[t] == indexes[t % 2]);
+    }
+    CHECK(indexes[0] != indexes[1]);
+    size_t expected = dataset->bytes + tables[0]->memoryBytes() + indexes[0]->memoryBytes() +
+                      indexes[1]->memoryBytes();
+    CHECK(cache.stats().bytes == static_cast<long long>(expected));
+}
+
+// A layout that pushes the cache over budget evicts; readers keep what they
+// hold, and a layout built on an evicted dataset is not charged.
+static void testLayoutsEvict() {
+    size_t dataset_bytes = DatasetCache::build(20000, 3)->bytes;
+    DatasetCache cache(dataset_bytes + 1024);
+    auto dataset = cache.get(20000, 3);
+    CHECK(cache.stats().entries == 1);
+
+    auto index = cache.index(dataset, "hash");
+    DatasetCacheStats s = cache.stats();
+    CHECK(s.entries == 0);
+    CHECK(s.evictions == 1);
+    CHECK(s.bytes == 0);
+    CHECK(index->search(dataset->keys.keys[10]).index == 10);
+
+    cache.flat(dataset);
+    CHECK(cache.stats().bytes == 0);
+}
+
+int main() {
+    testLayoutsAreCharged();
+    testLayoutBuiltOnce();
+    testLayoutsEvict();
+    return testResult("dataset_cache_test");
+}
@@ -0,0 +1,101 @@
+#include "epoch.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+const size_t MAX_THREADS = 256;
+
+// epoch is 0 while the thread is outside any guard, otherwise the global
+// epoch it saw on entry.
+struct alignas(64) Slot {
+    atomic<uint64_t> epoch{0};
+    atomic<bool> used{false};
+};
+
+struct Retired {
+    uint64_t epoch;
+    void* object;
+    void (*deleter)(void*);
+};
+
+Slot slots[MAX_THREADS];
+atomic<uint64_t> global_epoch{1};
+
+mutex retire_mutex;
+vector<Retired> retired;
+
+struct ThreadSlot {
+    Slot* slot = nullptr;
+    int depth = 0;
+
+    ~ThreadSlot() {
+        if(!slot) return;
+        slot->epoch.store(0);
+        slot->used.store(false, memory_order_release);
+    }
+};
+
+thread_local ThreadSlot local;
+
+Slot* claimSlot() {
+    for(auto& slot : slots) {
+        bool expected = false;
+        if(!slot.used.load(memory_order_relaxed) && slot.used.compare_exchange_strong(expected, true)) {
+            return &slot;
+        }
+    }
+    throw runtime_error("Epoch: more than 256 threads inside guards");
+}
+
+// An object retired at epoch r may still be seen by readers that entered at
+// an epoch <= r; it is safe once every active reader entered later.
+size_t reclaimLocked() {
+    uint64_t oldest = UINT64_MAX;
+    for(const auto& slot : slots) {
+        uint64_t e = slot.epoch.load();
+        if(e != 0 && e < oldest) oldest = e;
+    }
+
+    size_t kept = 0;
+    for(size_t i = 0; i < retired.size(); i++) {
+        if(retired[i].epoch < oldest) retired[i].deleter(retired[i].object);
+        else retired[kept++] = retired[i];
+    }
+    retired.resize(kept);
+    return kept;
+}
+
+} // namespace
+
+void Epoch::enter() {
+    ThreadSlot& t = local;
+    if(t.depth++ > 0) return;
+    if(!t.slot) t.slot = claimSlot();
+
+    // The fence orders the announcement before every load the reader makes
+    // next, so a writer that misses it has already published its update.
+    t.slot->epoch.store(global_epoch.load());
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+void Epoch::exit() {
+    ThreadSlot& t = local;
+    if(--t.depth == 0) t.slot->epoch.store(0, memory_order_release);
+}
+
+void Epoch::retire(void* object, void (*deleter)(void*)) {
+    lock_guard<mutex> lock(retire_mutex);
+    retired.push_back(Retired{global_epoch.fetch_add(1), object, deleter});
+    reclaimLocked();
+}
+
+size_t Epoch::reclaim() {
+    lock_guard<mutex> lock(retire_mutex);
+    return reclaimLocked();
+}
@@ -0,0 +1,38 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <cstddef>
+
+// Epoch-based reclamation for read-mostly structures.
+//
+// Readers bracket every access with an EpochGuard: two stores to a slot of
+// their own plus a fence, never a lock or a shared counter. A writer that has
+// unlinked an object (e.g. swapped in a new snapshot) hands it to retire();
+// the object is deleted once every reader that could still hold it has left
+// its critical section. Guards nest. At most 256 threads may hold a slot at
+// the same time; a slot is freed when its thread exits.
+class Epoch {
+public:
+    static void enter();
+    static void exit();
+
+    static void retire(void* object, void (*deleter)(void*));
+    template<typename T>
+    static void retire(const T* object) {
+        retire(const_cast<T*>(object), [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    // Frees whatever no reader can see anymore; retire() does this as well.
+    // Returns the number of objects still waiting.
+    static size_t reclaim();
+};
+
+class EpochGuard {
+public:
+    EpochGuard() { Epoch::enter(); }
+    ~EpochGuard() { Epoch::exit(); }
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+#endif
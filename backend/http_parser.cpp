@@ -0,0 +1,187 @@
+#include "http_parser.h"
+#include <charconv>
+
+using namespace std;
+
+namespace {
+
+char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equalsIgnoreCase(string_view a, string_view b) {
+    if(a.size() != b.size()) return false;
+    for(size_t i = 0; i < a.size(); i++) {
+        if(lower(a[i]) != lower(b[i])) return false;
+    }
+    return true;
+}
+
+bool containsIgnoreCase(string_view haystack, string_view needle) {
+    if(needle.size() > haystack.size()) return false;
+    for(size_t i = 0; i + needle.size() <= haystack.size(); i++) {
+        if(equalsIgnoreCase(haystack.substr(i, needle.size()), needle)) return true;
+    }
+    return false;
+}
+
+string_view trim(string_view s) {
+    size_t begin = s.find_first_not_of(" \t");
+    if(begin == string_view::npos) return {};
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+int hexValue(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    c = lower(c);
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Writes the decoded form of raw to out and returns its length; out must hold raw.size() bytes.
+size_t decodeInto(string_view raw, char* out) {
+    size_t n = 0;
+    for(size_t i = 0; i < raw.size(); i++) {
+        char c = raw[i];
+        if(c == '+') {
+            c = ' ';
+        } else if(c == '%' && i + 2 < raw.size()) {
+            int hi = hexValue(raw[i + 1]);
+            int lo = hexValue(raw[i + 2]);
+            if(hi >= 0 && lo >= 0) {
+                c = static_cast<char>(hi * 16 + lo);
+                i += 2;
+            }
+        }
+        out[n++] = c;
+    }
+    return n;
+}
+
+} // namespace
+
+ParseStatus HttpParser::parse(string_view buffer, HttpRequestView& req) {
+    // The terminator may straddle the previous read, so back up three bytes.
+    size_t from = scanned > 3 ? scanned - 3 : 0;
+    size_t end = buffer.find("\r\n\r\n", from);
+    if(end == string_view::npos) {
+        scanned = buffer.size();
+        return buffer.size() > max_head ? ParseStatus::HeadTooLarge : ParseStatus::Incomplete;
+    }
+    scanned = end;  // a later call for the body finds the terminator right away
+    if(end + 4 > max_head) {
+        reset();
+        return ParseStatus::HeadTooLarge;
+    }
+
+    req = HttpRequestView();
+    req.head_bytes = end + 4;
+    ParseStatus head = parseHead(buffer.substr(0, end), req);
+    if(head != ParseStatus::Complete) {
+        reset();
+        return head;
+    }
+    if(req.content_length > max_body) {
+        reset();
+        return ParseStatus::BodyTooLarge;
+    }
+    if(buffer.size() < req.size()) return ParseStatus::Incomplete;
+
+    reset();
+    return ParseStatus::Complete;
+}
+
+ParseStatus HttpParser::parseHead(string_view head, HttpRequestView& req) {
+    size_t line_end = head.find("\r\n");
+    string_view line = head.substr(0, line_end);
+    head = (line_end == string_view::npos) ? string_view() : head.substr(line_end + 2);
+
+    // "METHOD SP target SP HTTP/1.x"
+    size_t sp1 = line.find(' ');
+    if(sp1 == string_view::npos || sp1 == 0) return ParseStatus::Invalid;
+    size_t sp2 = line.find(' ', sp1 + 1);
+    if(sp2 == string_view::npos || sp2 == sp1 + 1) return ParseStatus::Invalid;
+    req.method = line.substr(0, sp1);
+    req.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    req.version = line.substr(sp2 + 1);
+    if(req.version.substr(0, 7) != "HTTP/1." || req.version.size() != 8) return ParseStatus::Invalid;
+
+    size_t qmark = req.target.find('?');
+    req.path = req.target.substr(0, qmark);
+    if(qmark != string_view::npos) req.query = req.target.substr(qmark + 1);
+
+    // HTTP/1.1 keeps the connection open unless told otherwise; 1.0 is the opposite.
+    req.keep_alive = (req.version == "HTTP/1.1");
+
+    // Only Content-Length framing is supported. Transfer-Encoding, alone or
+    // next to a Content-Length, and Content-Lengths that disagree would let
+    // body bytes be read as the next request on a keep-alive connection.
+    bool has_length = false;
+    bool has_encoding = false;
+    while(!head.empty()) {
+        line_end = head.find("\r\n");
+        line = head.substr(0, line_end);
+        head = (line_end == string_view::npos) ? string_view() : head.substr(line_end + 2);
+
+        size_t colon = line.find(':');
+        if(colon == string_view::npos || colon == 0) return ParseStatus::Invalid;
+        string_view name = line.substr(0, colon);
+        string_view value = trim(line.substr(colon + 1));
+
+        if(equalsIgnoreCase(name, "connection")) {
+            if(containsIgnoreCase(value, "close")) req.keep_alive = false;
+            else if(containsIgnoreCase(value, "keep-alive")) req.keep_alive = true;
+        }
+        else if(equalsIgnoreCase(name, "content-length")) {
+            size_t length;
+            auto res = from_chars(value.data(), value.data() + value.size(), length);
+            if(value.empty() || res.ec != errc() || res.ptr != value.data() + value.size()) return ParseStatus::Invalid;
+            if(has_length && length != req.content_length) return ParseStatus::Invalid;
+            req.content_length = length;
+            has_length = true;
+        }
+        else if(equalsIgnoreCase(name, "transfer-encoding")) {
+            has_encoding = true;
+        }
+    }
+    if(has_encoding) return has_length ? ParseStatus::Invalid : ParseStatus::UnsupportedFraming;
+    return ParseStatus::Complete;
+}
+
+bool findQueryParam(string_view query, string_view name, string_view& raw) {
+    size_t pos = 0;
+    while(pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if(end == string_view::npos) end = query.size();
+        string_view pair = query.substr(pos, end - pos);
+        if(pair.size() > name.size() && pair[name.size()] == '=' && pair.compare(0, name.size(), name) == 0) {
+            raw = pair.substr(name.size() + 1);
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+void percentDecode(string_view raw, string& out) {
+    out.resize(raw.size());
+    out.resize(decodeInto(raw, &out[0]));
+}
+
+string queryParam(string_view query, string_view name) {
+    string value;
+    string_view raw;
+    if(findQueryParam(query, name, raw)) percentDecode(raw, value);
+    return value;
+}
+
+bool queryInt(string_view query, string_view name, long long& value) {
+    string_view raw;
+    if(!findQueryParam(query, name, raw) || raw.empty() || raw.size() > 64) return false;
+
+    char decoded[64];
+    size_t n = decodeInto(raw, decoded);
+    auto res = from_chars(decoded, decoded + n, value);
+    return res.ec == errc() && res.ptr == decoded + n;
+}
@@ -0,0 +1,68 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// A parsed request head. Every view points into the buffer given to
+// HttpParser::parse and is valid only while those bytes stay in place.
+struct HttpRequestView {
+    std::string_view method;
+    std::string_view target;        // as sent: path plus optional "?query"
+    std::string_view path;
+    std::string_view query;         // without the '?', empty when absent
+    std::string_view version;
+    bool keep_alive = true;
+    size_t content_length = 0;
+    size_t head_bytes = 0;          // request line and headers, including the blank line
+
+    size_t size() const { return head_bytes + content_length; }
+};
+
+enum class ParseStatus {
+    Complete,           // req describes the first request in the buffer
+    Incomplete,         // need more bytes
+    Invalid,            // malformed request line or header, or conflicting Content-Length
+    UnsupportedFraming, // Transfer-Encoding sent; bodies are framed by Content-Length only
+    HeadTooLarge,       // no end of head within max_head_bytes
+    BodyTooLarge        // Content-Length above max_body_bytes
+};
+
+// Incremental HTTP/1.x request parser that never copies or allocates.
+//
+// parse() looks at the request at the start of the buffer. While it returns
+// Incomplete, call it again with the same start and more data appended; the
+// search for the end of the head resumes where the last call stopped, so a
+// request trickling in over many reads is still scanned once. After Complete,
+// the caller consumes req.size() bytes and the next request (pipelined or
+// not) starts right behind them.
+class HttpParser {
+public:
+    explicit HttpParser(size_t max_head_bytes = 64 * 1024, size_t max_body_bytes = 1024 * 1024)
+        : max_head(max_head_bytes), max_body(max_body_bytes) {}
+
+    ParseStatus parse(std::string_view buffer, HttpRequestView& req);
+    void reset() { scanned = 0; }
+
+private:
+    static ParseStatus parseHead(std::string_view head, HttpRequestView& req);
+
+    size_t max_head;
+    size_t max_body;
+    size_t scanned = 0;     // bytes of the current request already searched for "\r\n\r\n"
+};
+
+// Query strings ("size=1000&algorithm=simd"). Names are matched as sent;
+// values are percent-decoded, with '+' as a space.
+
+// Raw value of the first name=value pair; false when name is absent.
+bool findQueryParam(std::string_view query, std::string_view name, std::string_view& raw);
+// Decodes into out, reusing its capacity. Malformed escapes are kept as they are.
+void percentDecode(std::string_view raw, std::string& out);
+// Decoded value, or "" when absent.
+std::string queryParam(std::string_view query, std::string_view name);
+// Decimal integer value; false when absent or not entirely a number.
+bool queryInt(std::string_view query, std::string_view name, long long& value);
+
+#endif
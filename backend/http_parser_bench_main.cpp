@@ -0,0 +1,156 @@
+#include "http_parser.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+using namespace std;
+using namespace chrono;
+
+// Microbenchmark of the request parser: one request per buffer, pipelined
+// buffers, requests arriving in small reads, query lookups, and the
+// istringstream parser the server used before as a baseline.
+
+static const string REQUEST =
+    "GET /api/search?size=100000&algorithm=simd&seed=42&catalog=ids HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n"
+    "Accept: application/json, text/plain, */*\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+static volatile size_t sink;
+
+struct LegacyRequest {
+    string method;
+    string path;
+    string version;
+    bool keep_alive = true;
+};
+
+static void parseLegacy(const string& head, LegacyRequest& req, size_t& content_length) {
+    istringstream iss(head);
+    iss >> req.method >> req.path >> req.version;
+    req.keep_alive = (req.version == "HTTP/1.1");
+
+    string line;
+    getline(iss, line);
+    while(getline(iss, line)) {
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        size_t colon = line.find(':');
+        if(colon == string::npos) continue;
+
+        string name = line.substr(0, colon);
+        string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        transform(name.begin(), name.end(), name.begin(), ::tolower);
+        transform(value.begin(), value.end(), value.begin(), ::tolower);
+
+        if(name == "connection") {
+            if(value.find("close") != string::npos) req.keep_alive = false;
+            else if(value.find("keep-alive") != string::npos) req.keep_alive = true;
+        }
+        else if(name == "content-length") {
+            content_length = stoul(value);
+        }
+    }
+}
+
+template<typename Fn>
+static void report(const char* name, long long requests, size_t bytes, Fn run) {
+    run();  // warm up
+    auto start = steady_clock::now();
+    run();
+    double ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    cout << "  " << name << string(max<size_t>(1, 28 - string(name).size()), ' ')
+         << ns / requests << " ns/request, "
+         << static_cast<long long>(requests * 1e9 / ns) << " requests/s";
+    if(bytes > 0) cout << ", " << bytes * 1e3 / ns << " MB/s";
+    cout << endl;
+}
+
+int main(int argc, char* argv[]) {
+    long long iterations = 1000000;
+    if(argc > 1) iterations = max(1LL, atoll(argv[1]));
+    const int pipeline_depth = 64;
+    const size_t read_size = 16;
+
+    cout << "HTTP parser, " << REQUEST.size() << "-byte request, " << iterations << " requests per run" << endl;
+
+    report("single request", iterations, REQUEST.size() * iterations, [&]() {
+        HttpParser parser;
+        HttpRequestView req;
+        size_t total = 0;
+        for(long long i = 0; i < iterations; i++) {
+            if(parser.parse(REQUEST, req) == ParseStatus::Complete) total += req.path.size();
+        }
+        sink = total;
+    });
+
+    string pipelined;
+    for(int i = 0; i < pipeline_depth; i++) pipelined += REQUEST;
+    long long batches = max(1LL, iterations / pipeline_depth);
+    report("pipelined x64", batches * pipeline_depth, pipelined.size() * batches, [&]() {
+        HttpParser parser;
+        HttpRequestView req;
+        size_t total = 0;
+        for(long long b = 0; b < batches; b++) {
+            string_view rest(pipelined);
+            while(parser.parse(rest, req) == ParseStatus::Complete) {
+                total += req.path.size();
+                rest.remove_prefix(req.size());
+            }
+        }
+        sink = total;
+    });
+
+    // The buffer grows by read_size bytes per call, as it would over many recv()s.
+    long long fragmented = max(1LL, iterations / 10);
+    report("16-byte reads", fragmented, REQUEST.size() * fragmented, [&]() {
+        HttpParser parser;
+        HttpRequestView req;
+        size_t total = 0;
+        for(long long i = 0; i < fragmented; i++) {
+            for(size_t have = read_size; ; have += read_size) {
+                have = min(have, REQUEST.size());
+                if(parser.parse(string_view(REQUEST).substr(0, have), req) == ParseStatus::Complete) break;
+            }
+            total += req.path.size();
+        }
+        sink = total;
+    });
+
+    report("query: 3 ints, 1 string", iterations, 0, [&]() {
+        string_view query = "size=100000&algorithm=si%6Dd&seed=42&catalog=ids";
+        string value;
+        size_t total = 0;
+        for(long long i = 0; i < iterations; i++) {
+            long long size = 0, seed = 0, missing = 0;
+            queryInt(query, "size", size);
+            queryInt(query, "seed", seed);
+            queryInt(query, "count", missing);
+            string_view raw;
+            if(findQueryParam(query, "algorithm", raw)) percentDecode(raw, value);
+            total += size + seed + value.size();
+        }
+        sink = total;
+    });
+
+    long long legacy = max(1LL, iterations / 10);
+    report("istringstream baseline", legacy, REQUEST.size() * legacy, [&]() {
+        size_t total = 0;
+        for(long long i = 0; i < legacy; i++) {
+            LegacyRequest req;
+            size_t content_length = 0;
+            parseLegacy(REQUEST.substr(0, REQUEST.find("\r\n\r\n")), req, content_length);
+            total += req.path.size();
+        }
+        sink = total;
+    });
+
+    return 0;
+}
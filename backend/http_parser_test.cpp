@@ -0,0 +1,124 @@
+#include "http_parser.h"
+#include "test_check.h"
+#include <string>
+
+using namespace std;
+
+static void testSimpleRequest() {
+    HttpParser parser;
+    HttpRequestView req;
+    string buffer = "GET /api/search?size=100&algorithm=simd HTTP/1.1\r\nHost: x\r\n\r\n";
+    CHECK(parser.parse(buffer, req) == ParseStatus::Complete);
+    CHECK(req.method == "GET");
+    CHECK(req.target == "/api/search?size=100&algorithm=simd");
+    CHECK(req.path == "/api/search");
+    CHECK(req.query == "size=100&algorithm=simd");
+    CHECK(req.version == "HTTP/1.1");
+    CHECK(req.keep_alive);
+    CHECK(req.content_length == 0);
+    CHECK(req.size() == buffer.size());
+}
+
+static void testKeepAlive() {
+    HttpParser parser;
+    HttpRequestView req;
+    CHECK(parser.parse("GET / HTTP/1.0\r\n\r\n", req) == ParseStatus::Complete);
+    CHECK(!req.keep_alive);
+    CHECK(parser.parse("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", req) == ParseStatus::Complete);
+    CHECK(req.keep_alive);
+    CHECK(parser.parse("GET / HTTP/1.1\r\nconnection: close\r\n\r\n", req) == ParseStatus::Complete);
+    CHECK(!req.keep_alive);
+}
+
+// Requests behind each other in one buffer come off it one at a time, and a
+// body is not mistaken for the next request.
+static void testPipelining() {
+    string first = "POST /a HTTP/1.1\r\nContent-Length: 19\r\n\r\nGET /b HTTP/1.1\r\n\r\n";
+    string second = "GET /c?x=1 HTTP/1.1\r\n\r\n";
+    string buffer = first + second;
+
+    HttpParser parser;
+    HttpRequestView req;
+    CHECK(parser.parse(buffer, req) == ParseStatus::Complete);
+    CHECK(req.path == "/a");
+    CHECK(req.content_length == 19);
+    CHECK(req.size() == first.size());
+
+    string_view rest = string_view(buffer).substr(req.size());
+    CHECK(parser.parse(rest, req) == ParseStatus::Complete);
+    CHECK(req.path == "/c");
+    CHECK(req.query == "x=1");
+    CHECK(req.size() == rest.size());
+}
+
+// Fed one byte at a time, including a terminator split across reads and a
+// body that arrives after the head, the request completes exactly once.
+static void testSplitReads() {
+    string full = "POST /api/batch HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+    HttpParser parser;
+    HttpRequestView req;
+    string buffer;
+    size_t completed_at = 0;
+    for(size_t i = 0; i < full.size(); i++) {
+        buffer += full[i];
+        ParseStatus status = parser.parse(buffer, req);
+        if(status == ParseStatus::Complete) {
+            completed_at = buffer.size();
+            break;
+        }
+        CHECK(status == ParseStatus::Incomplete);
+    }
+    CHECK(completed_at == full.size());
+    CHECK(req.path == "/api/batch");
+    CHECK(req.content_length == 4);
+    CHECK(req.size() == full.size());
+}
+
+static void testFraming() {
+    HttpParser parser;
+    HttpRequestView req;
+    CHECK(parser.parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", req) ==
+          ParseStatus::UnsupportedFraming);
+    CHECK(parser.parse("POST / HTTP/1.1\r\nContent-Length: 3\r\nTransfer-Encoding: chunked\r\n\r\nabc", req) ==
+          ParseStatus::Invalid);
+    CHECK(parser.parse("POST / HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 4\r\n\r\nabcd", req) ==
+          ParseStatus::Invalid);
+    CHECK(parser.parse("POST / HTTP/1.1\r\nContent-Length: 3\r\ncontent-length: 3\r\n\r\nabc", req) ==
+          ParseStatus::Complete);
+    CHECK(parser.parse("POST / HTTP/1.1\r\nContent-Length: 3x\r\n\r\nabc", req) == ParseStatus::Invalid);
+    CHECK(parser.parse("POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n", req) == ParseStatus::Invalid);
+}
+
+static void testMalformedAndLimits() {
+    HttpRequestView req;
+    HttpParser parser(64, 8);
+    CHECK(parser.parse("GET /\r\n\r\n", req) == ParseStatus::Invalid);
+    CHECK(parser.parse("GET / HTTP/2.0x\r\n\r\n", req) == ParseStatus::Invalid);
+    CHECK(parser.parse("GET / HTTP/1.1\r\nNoColon\r\n\r\n", req) == ParseStatus::Invalid);
+    CHECK(parser.parse("GET / HTTP/1.1\r\nX-Long: " + string(64, 'a'), req) == ParseStatus::HeadTooLarge);
+    parser.reset();
+    CHECK(parser.parse("POST / HTTP/1.1\r\nContent-Length: 9\r\n\r\n", req) == ParseStatus::BodyTooLarge);
+}
+
+static void testQueryHelpers() {
+    string_view query = "q=hello+world%21&size=42&bad=4x&empty=";
+    CHECK(queryParam(query, "q") == "hello world!");
+    CHECK(queryParam(query, "missing") == "");
+    long long value = 0;
+    CHECK(queryInt(query, "size", value) && value == 42);
+    CHECK(!queryInt(query, "bad", value));
+    CHECK(!queryInt(query, "empty", value));
+    string_view raw;
+    CHECK(findQueryParam(query, "empty", raw) && raw.empty());
+}
+
+int main() {
+    testSimpleRequest();
+    testKeepAlive();
+    testPipelining();
+    testSplitReads();
+    testFraming();
+    testMalformedAndLimits();
+    testQueryHelpers();
+    return testResult("http_parser_test");
+}
@@ -0,0 +1,156 @@
+#ifndef LINEAR_SEARCH_H
+#define LINEAR_SEARCH_H
+
+#include <cstddef>
+#include <chrono>
+#include <optional>
+#include <functional>
+#include "perf_counters.h"
+
+// A tail call the compiler has to turn into a jump at every optimisation
+// level. Defined only where the compiler supports it; without it even -O1 or
+// -Og may keep the call, so callers must cap the recursion depth.
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(clang::musttail)
+#define LINEAR_SEARCH_MUSTTAIL [[clang::musttail]]
+#elif __has_cpp_attribute(gnu::musttail)
+#define LINEAR_SEARCH_MUSTTAIL [[gnu::musttail]]
+#endif
+#endif
+
+// Instrumentation policies for LinearSearch. The scans call begin() and end()
+// around the search and compared(n) for every n elements they compare. All
+// hooks are inline, so with NoInstrumentation they and their state compile
+// away and a scan is the bare loop.
+struct NoInstrumentation {
+    void begin() {}
+    void compared(size_t) {}
+    void end() {}
+};
+
+// Comparison count only, without reading a clock.
+struct CountComparisons {
+    long long comparisons = 0;
+
+    void begin() { comparisons = 0; }
+    void compared(size_t n) { comparisons += static_cast<long long>(n); }
+    void end() {}
+};
+
+// Everything a SearchResult reports: comparisons, wall time and, when
+// PerfCounters is enabled, hardware counters of the calling thread.
+struct MeasureSearch {
+    long long comparisons = 0;
+    long long elapsed_ns = 0;
+    PerfCounterValues counters;
+
+    void begin() {
+        comparisons = 0;
+        perf.emplace();
+        start = std::chrono::high_resolution_clock::now();
+    }
+    void compared(size_t n) { comparisons += static_cast<long long>(n); }
+    void end() {
+        auto stop = std::chrono::high_resolution_clock::now();
+        counters = perf->stop();
+        elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+    }
+
+private:
+    std::optional<PerfScope> perf;
+    std::chrono::high_resolution_clock::time_point start;
+};
+
+// Elements [offset, offset + count) of another sequence, for scanning part of a catalog.
+template<typename Sequence>
+struct SequenceSlice {
+    const Sequence& data;
+    size_t offset;
+    size_t count;
+
+    size_t size() const { return count; }
+    decltype(auto) operator[](size_t i) const { return data[offset + i]; }
+};
+
+// Linear search over any random-access sequence with size() and operator[]:
+// vector<string>, VideoKeyView, StringTableView and so on. Key is the type the
+// elements are compared as, Equal decides a match. All three scans return the
+// index of the first match, or npos, and compare exactly the elements up to
+// and including it.
+template<typename Key, typename Equal = std::equal_to<Key>, typename Instrumentation = NoInstrumentation>
+class LinearSearch {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit LinearSearch(Equal equal = Equal()) : equal(equal) {}
+
+    Instrumentation& instrumentation() { return instr; }
+    const Instrumentation& instrumentation() const { return instr; }
+
+    template<typename Sequence>
+    size_t iterative(const Sequence& data, const Key& target) {
+        instr.begin();
+        size_t n = data.size();
+        size_t i = 0;
+        while(i < n && !equal(data[i], target)) i++;
+        instr.compared(i < n ? i + 1 : n);
+        instr.end();
+        return i < n ? i : npos;
+    }
+
+    // Linear recursion written as a tail call. Where LINEAR_SEARCH_MUSTTAIL is
+    // defined the call is guaranteed to become a jump and the stack does not
+    // grow with n; elsewhere every element may cost a stack frame.
+    template<typename Sequence>
+    size_t recursive(const Sequence& data, const Key& target) {
+        instr.begin();
+        size_t index = recursiveFrom(data, target, 0);
+        instr.end();
+        return index;
+    }
+
+    // Splits [lo, hi) in half and searches the left half first: the recursion
+    // is O(log n) deep, and the first match and comparison count are exactly
+    // those of the linear scan.
+    template<typename Sequence>
+    size_t divideConquer(const Sequence& data, const Key& target) {
+        instr.begin();
+        size_t index = data.size() == 0 ? npos : divide(data, 0, data.size(), target);
+        instr.end();
+        return index;
+    }
+
+private:
+    template<typename Sequence>
+    size_t recursiveFrom(const Sequence& data, const Key& target, size_t idx) {
+        if(idx >= data.size()) return npos;
+
+        instr.compared(1);
+        if(equal(data[idx], target)) return idx;
+
+#ifdef LINEAR_SEARCH_MUSTTAIL
+        LINEAR_SEARCH_MUSTTAIL return recursiveFrom(data, target, idx + 1);
+#else
+        return recursiveFrom(data, target, idx + 1);
+#endif
+    }
+
+    template<typename Sequence>
+    size_t divide(const Sequence& data, size_t lo, size_t hi, const Key& target) {
+        if(hi - lo == 1) {
+            instr.compared(1);
+            return equal(data[lo], target) ? lo : npos;
+        }
+
+        size_t mid = lo + (hi - lo) / 2;
+        size_t left = divide(data, lo, mid, target);
+        if(left != npos) return left;
+
+        return divide(data, mid, hi, target);
+    }
+
+    Equal equal;
+    Instrumentation instr;
+};
+
+#endif
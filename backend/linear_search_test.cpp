@@ -0,0 +1,90 @@
+#include "linear_search.h"
+#include "search_engine.h"
+#include "test_check.h"
+#include <algorithm>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+using Counted = LinearSearch<int, equal_to<int>, CountComparisons>;
+
+// The three scans agree with a plain loop on the index of the first match
+// and on the number of elements compared.
+static void testScansAgree() {
+    for(int n = 0; n <= 40; n++) {
+        vector<int> data(n);
+        for(int i = 0; i < n; i++) data[i] = (i * 7) % 13;    // repeats from n = 14 on
+
+        for(int target = -1; target <= 13; target++) {
+            size_t expected = Counted::npos;
+            for(int i = 0; i < n; i++) {
+                if(data[i] == target) {
+                    expected = i;
+                    break;
+                }
+            }
+            long long expected_comparisons = expected == Counted::npos ? n : static_cast<long long>(expected) + 1;
+
+            Counted search;
+            CHECK(search.iterative(data, target) == expected);
+            CHECK(search.instrumentation().comparisons == expected_comparisons);
+            CHECK(search.recursive(data, target) == expected);
+            CHECK(search.instrumentation().comparisons == expected_comparisons);
+            CHECK(search.divideConquer(data, target) == expected);
+            CHECK(search.instrumentation().comparisons == expected_comparisons);
+        }
+    }
+}
+
+struct EqualIgnoringCase {
+    bool operator()(const string& a, const string& b) const {
+        return a.size() == b.size() && equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+            return tolower(static_cast<unsigned char>(x)) == tolower(static_cast<unsigned char>(y));
+        });
+    }
+};
+
+static void testComparatorAndSequences() {
+    vector<string> words = {"alpha", "Beta", "gamma", "BETA"};
+    LinearSearch<string, EqualIgnoringCase> ignoring_case;
+    CHECK(ignoring_case.iterative(words, string("beta")) == 1);
+    CHECK(ignoring_case.recursive(words, string("GAMMA")) == 2);
+    CHECK(ignoring_case.divideConquer(words, string("delta")) == LinearSearch<string>::npos);
+
+    // Indexes are relative to the slice.
+    SequenceSlice<vector<string>> slice{words, 2, 2};
+    LinearSearch<string> exact;
+    CHECK(exact.iterative(slice, string("BETA")) == 1);
+    CHECK(exact.recursive(slice, string("Beta")) == LinearSearch<string>::npos);
+
+    // Compact keys and the string catalog agree.
+    auto videos = LinearSearchEngine::generateVideoData(300, 9);
+    auto keys = LinearSearchEngine::generateVideoKeys(300, 9);
+    LinearSearch<uint32_t> by_key;
+    LinearSearch<string> by_string;
+    for(size_t i = 0; i < videos.size(); i += 17) {
+        VideoKeyView view = keys;
+        CHECK(by_key.divideConquer(view, keys.keys[i]) == i);
+        CHECK(by_string.recursive(videos, videos[i]) == i);
+    }
+}
+
+// The recursive scan handles the largest input this build allows without
+// overflowing the stack; with a guaranteed tail call that is any size.
+static void testDeepRecursion() {
+    size_t n = min<size_t>(LinearSearchEngine::maxRecursiveSize(), 5000000);
+    vector<int> data(n, 0);
+    Counted search;
+    CHECK(search.recursive(data, 1) == Counted::npos);
+    CHECK(search.instrumentation().comparisons == static_cast<long long>(n));
+    data.back() = 1;
+    CHECK(search.recursive(data, 1) == n - 1);
+}
+
+int main() {
+    testScansAgree();
+    testComparatorAndSequences();
+    testDeepRecursion();
+    return testResult("linear_search_test");
+}
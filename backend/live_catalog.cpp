@@ -0,0 +1,171 @@
+#include "live_catalog.h"
+#include "simd_kernels.h"
+#include "epoch.h"
+#include <map>
+#include <algorithm>
+
+using namespace std;
+using namespace chrono;
+
+LiveCatalog::LiveCatalog(VideoKeyView initial, size_t segment_keys)
+    : segment_keys(max<size_t>(1, segment_keys)), current(nullptr) {
+    replace(initial);
+}
+
+LiveCatalog::~LiveCatalog() {
+    // Nobody may search a catalog that is being destroyed.
+    delete current.load();
+}
+
+void LiveCatalog::add(uint32_t key) {
+    lock_guard<mutex> lock(queue_mutex);
+    pending.push_back(CatalogChange{CatalogChange::Add, key});
+}
+
+void LiveCatalog::remove(uint32_t key) {
+    lock_guard<mutex> lock(queue_mutex);
+    pending.push_back(CatalogChange{CatalogChange::Remove, key});
+}
+
+size_t LiveCatalog::commit() {
+    lock_guard<mutex> commit_lock(commit_mutex);
+    vector<CatalogChange> batch;
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        batch.swap(pending);
+    }
+    if(batch.empty()) return 0;
+
+    // Every touched segment is copied once per batch, however many changes hit it.
+    map<uint32_t, vector<uint32_t>> edited;
+    auto edit = [&](uint32_t s) -> vector<uint32_t>& {
+        auto it = edited.find(s);
+        if(it == edited.end()) it = edited.emplace(s, segments[s]->keys).first;
+        return it->second;
+    };
+
+    size_t size = current.load()->size;
+    size_t applied = 0;
+    for(const auto& change : batch) {
+        if(change.type == CatalogChange::Add) {
+            if(location.count(change.key)) continue;
+            if(segments.empty() || edit(static_cast<uint32_t>(segments.size() - 1)).size() >= segment_keys) {
+                segments.push_back(make_shared<const Segment>());
+            }
+            uint32_t s = static_cast<uint32_t>(segments.size() - 1);
+            edit(s).push_back(change.key);
+            location.emplace(change.key, s);
+            size++;
+        } else {
+            auto it = location.find(change.key);
+            if(it == location.end()) continue;
+            vector<uint32_t>& keys = edit(it->second);
+            *find(keys.begin(), keys.end(), change.key) = keys.back();
+            keys.pop_back();
+            location.erase(it);
+            size--;
+        }
+        applied++;
+    }
+
+    for(auto& entry : edited) {
+        segments[entry.first] = make_shared<const Segment>(Segment{move(entry.second)});
+    }
+    publish(size);
+    return applied;
+}
+
+void LiveCatalog::replace(VideoKeyView keys) {
+    lock_guard<mutex> lock(commit_mutex);
+    segments.clear();
+    location.clear();
+    location.reserve(keys.size());
+
+    size_t size = 0;
+    vector<uint32_t> segment;
+    for(size_t i = 0; i < keys.size(); i++) {
+        if(!location.emplace(keys[i], static_cast<uint32_t>(segments.size())).second) continue;
+        segment.push_back(keys[i]);
+        size++;
+        if(segment.size() == segment_keys) {
+            segments.push_back(make_shared<const Segment>(Segment{move(segment)}));
+            segment = vector<uint32_t>();
+        }
+    }
+    if(!segment.empty()) segments.push_back(make_shared<const Segment>(Segment{move(segment)}));
+    publish(size);
+}
+
+// Called with commit_mutex held.
+void LiveCatalog::publish(size_t size) {
+    auto snapshot = new Snapshot{next_version++, size, segments};
+    const Snapshot* old = current.exchange(snapshot);
+    if(old) Epoch::retire(old);
+}
+
+SearchResult LiveCatalog::search(uint32_t key) const {
+    SearchResult result;
+    result.algorithm = "live_simd";
+    result.target = VideoKeyCatalog::formatVideoId(key);
+
+    PerfScope perf;
+    auto start = high_resolution_clock::now();
+
+    EpochGuard guard;
+    const Snapshot* snapshot = current.load(memory_order_acquire);
+    size_t offset = 0;
+    size_t index = snapshot->size;
+    for(const auto& segment : snapshot->segments) {
+        const vector<uint32_t>& keys = segment->keys;
+        size_t i = findKey(keys.data(), keys.size(), key);
+        if(i < keys.size()) {
+            index = offset + i;
+            break;
+        }
+        offset += keys.size();
+    }
+
+    auto end = high_resolution_clock::now();
+    result.counters = perf.stop();
+    result.execution_time_ns = duration_cast<nanoseconds>(end - start).count();
+
+    result.data_size = static_cast<int>(snapshot->size);
+    result.found = (index < snapshot->size);
+    result.index = result.found ? static_cast<int>(index) : -1;
+    result.comparisons = static_cast<int>(result.found ? index + 1 : snapshot->size);
+    return result;
+}
+
+SearchResult LiveCatalog::search(const string& id) const {
+    uint32_t key;
+    if(VideoKeyCatalog::parseVideoId(id, key)) {
+        SearchResult result = search(key);
+        result.target = id;
+        return result;
+    }
+
+    SearchResult result;
+    result.algorithm = "live_simd";
+    result.target = id;
+    result.data_size = static_cast<int>(size());
+    result.comparisons = result.data_size;
+    result.index = -1;
+    result.found = false;
+    result.execution_time_ns = 0;
+    return result;
+}
+
+size_t LiveCatalog::size() const {
+    EpochGuard guard;
+    return current.load(memory_order_acquire)->size;
+}
+
+uint64_t LiveCatalog::version() const {
+    EpochGuard guard;
+    return current.load(memory_order_acquire)->version;
+}
+
+size_t LiveCatalog::segmentCount() const {
+    EpochGuard guard;
+    return current.load(memory_order_acquire)->segments.size();
+}
@@ -0,0 +1,78 @@
+#ifndef LIVE_CATALOG_H
+#define LIVE_CATALOG_H
+
+#include "search_engine.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+struct CatalogChange {
+    enum Type { Add, Remove };
+    Type type;
+    uint32_t key;
+};
+
+// A compact key catalog that changes while it is being searched.
+//
+// Keys live in immutable segments of up to segment_keys keys. A snapshot is
+// a list of segments; a commit copies only the segments its changes touch,
+// shares the rest with the previous snapshot, and publishes the new list
+// with one atomic pointer swap. Readers search whatever snapshot was current
+// when they started, without locks, under an EpochGuard; replaced snapshots
+// are freed through Epoch::retire once no reader can see them.
+//
+// Keys are a set: adding a present key or removing a missing one does
+// nothing. Removal moves a segment's last key into the hole, so positions
+// within a segment are not stable across commits.
+class LiveCatalog {
+public:
+    explicit LiveCatalog(VideoKeyView initial, size_t segment_keys = 65536);
+    ~LiveCatalog();
+    LiveCatalog(const LiveCatalog&) = delete;
+    LiveCatalog& operator=(const LiveCatalog&) = delete;
+
+    // Writers: add() and remove() only queue the change; commit() applies
+    // everything queued so far as one new snapshot and returns how many
+    // changes took effect. All three may be called from any thread.
+    void add(uint32_t key);
+    void remove(uint32_t key);
+    size_t commit();
+    // Throws the current contents away and publishes keys as a new snapshot.
+    void replace(VideoKeyView keys);
+
+    // Readers: lock-free, consistent within one call.
+    SearchResult search(uint32_t key) const;
+    SearchResult search(const std::string& id) const;
+    size_t size() const;
+    uint64_t version() const;
+    size_t segmentCount() const;
+
+private:
+    struct Segment {
+        std::vector<uint32_t> keys;
+    };
+
+    struct Snapshot {
+        uint64_t version;
+        size_t size;
+        std::vector<std::shared_ptr<const Segment>> segments;
+    };
+
+    void publish(size_t size);
+
+    size_t segment_keys;
+    std::atomic<const Snapshot*> current;
+
+    std::mutex queue_mutex;
+    std::vector<CatalogChange> pending;
+
+    // Writer state, guarded by commit_mutex.
+    std::mutex commit_mutex;
+    std::vector<std::shared_ptr<const Segment>> segments;
+    std::unordered_map<uint32_t, uint32_t> location;    // key -> segment
+    uint64_t next_version = 1;
+};
+
+#endif
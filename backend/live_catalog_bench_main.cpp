@@ -0,0 +1,175 @@
+#include "live_catalog.h"
+#include "counter_rng.h"
+#include "epoch.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+using namespace chrono;
+
+// Search throughput and latency of a LiveCatalog while a writer changes it
+// at a fixed rate, next to the same load when every batch of changes is
+// applied by regenerating the whole catalog with generateVideoData.
+
+struct BenchOptions {
+    int size = 1000000;
+    int readers = 2;
+    int write_rate = 10000;     // changes per second
+    int batch = 100;            // changes per commit
+    double seconds = 3;
+    string mode = "both";       // live, rebuild or both
+};
+
+struct BenchOutcome {
+    long long searches = 0;
+    long long commits = 0;
+    long long changes = 0;
+    vector<long long> latencies_ns;
+};
+
+static void printUsage(const char* prog) {
+    cerr << "Usage: " << prog << " [--size N] [--readers N] [--write-rate changes/s] [--batch N]"
+         << " [--seconds S] [--mode live|rebuild|both]" << endl;
+}
+
+// Runs readers calling search(key) against a writer calling write(batch)
+// every batch / write_rate seconds for options.seconds.
+template<typename Search, typename Write>
+static BenchOutcome runLoad(const BenchOptions& options, Search search, Write write) {
+    atomic<bool> stop(false);
+    BenchOutcome outcome;
+    vector<BenchOutcome> per_reader(options.readers);
+
+    vector<thread> readers;
+    for(int r = 0; r < options.readers; r++) {
+        readers.emplace_back([&, r]() {
+            SplitMix64 rng(static_cast<uint64_t>(r) + 1);
+            BenchOutcome& mine = per_reader[r];
+            mine.latencies_ns.reserve(1 << 20);
+            while(!stop.load(memory_order_relaxed)) {
+                uint32_t key = 1000000 + static_cast<uint32_t>(rng.next() % options.size);
+                auto start = steady_clock::now();
+                search(key);
+                long long ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+                if(mine.latencies_ns.size() < mine.latencies_ns.capacity()) mine.latencies_ns.push_back(ns);
+                mine.searches++;
+            }
+        });
+    }
+
+    thread writer([&]() {
+        auto interval = nanoseconds(static_cast<long long>(1e9 * options.batch / options.write_rate));
+        auto next_commit = steady_clock::now() + interval;
+        while(!stop.load(memory_order_relaxed)) {
+            this_thread::sleep_until(next_commit);
+            next_commit += interval;
+            write(options.batch);
+            outcome.commits++;
+            outcome.changes += options.batch;
+        }
+    });
+
+    this_thread::sleep_for(duration<double>(options.seconds));
+    stop.store(true);
+    writer.join();
+    for(auto& t : readers) t.join();
+
+    for(auto& mine : per_reader) {
+        outcome.searches += mine.searches;
+        outcome.latencies_ns.insert(outcome.latencies_ns.end(), mine.latencies_ns.begin(), mine.latencies_ns.end());
+    }
+    return outcome;
+}
+
+// Changes go through LiveCatalog: every batch alternates between adding a
+// new key and removing a random one, then commits.
+static BenchOutcome runLive(const BenchOptions& options) {
+    const uint32_t seed = 1;
+    LiveCatalog catalog(LinearSearchEngine::generateVideoKeys(options.size, seed));
+    SplitMix64 rng(seed);
+    uint32_t next_key = 1000000 + static_cast<uint32_t>(options.size);
+
+    return runLoad(options,
+        [&](uint32_t key) { return catalog.search(key).found; },
+        [&](int batch) {
+            for(int c = 0; c < batch; c++) {
+                if(c % 2 == 0) catalog.add(next_key++);
+                else catalog.remove(1000000 + static_cast<uint32_t>(rng.next() % options.size));
+            }
+            catalog.commit();
+        });
+}
+
+// The baseline: every batch regenerates the whole catalog with
+// generateVideoData and swaps it in, readers use the same epoch scheme.
+static BenchOutcome runRebuild(const BenchOptions& options) {
+    const uint32_t seed = 1;
+    atomic<const VideoKeyCatalog*> current(
+        new VideoKeyCatalog(VideoKeyCatalog::fromStrings(LinearSearchEngine::generateVideoData(options.size, seed))));
+
+    BenchOutcome outcome = runLoad(options,
+        [&](uint32_t key) {
+            EpochGuard guard;
+            return LinearSearchEngine::linearSearchSimd(*current.load(memory_order_acquire), key).found;
+        },
+        [&](int) {
+            auto rebuilt = new VideoKeyCatalog(
+                VideoKeyCatalog::fromStrings(LinearSearchEngine::generateVideoData(options.size, seed)));
+            Epoch::retire(current.exchange(rebuilt));
+        });
+    delete current.load();
+    return outcome;
+}
+
+static double percentile(const vector<long long>& sorted, double p) {
+    if(sorted.empty()) return 0;
+    size_t i = static_cast<size_t>(p * (sorted.size() - 1));
+    return static_cast<double>(sorted[i]);
+}
+
+static void report(const char* name, BenchOutcome outcome, const BenchOptions& options) {
+    sort(outcome.latencies_ns.begin(), outcome.latencies_ns.end());
+    cout << "  " << left << setw(8) << name << right << fixed << setprecision(0)
+         << setw(10) << outcome.searches / options.seconds << " searches/s"
+         << " | p50 " << setw(8) << percentile(outcome.latencies_ns, 0.50) / 1000 << " us"
+         << " | p99 " << setw(8) << percentile(outcome.latencies_ns, 0.99) / 1000 << " us"
+         << " | max " << setw(8) << percentile(outcome.latencies_ns, 1.0) / 1000 << " us"
+         << " | " << setw(8) << outcome.commits / options.seconds << " commits/s, "
+         << outcome.changes / options.seconds << " changes/s" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for(int i = 1; i < argc; i++) {
+        string flag = argv[i];
+        if(i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        string value = argv[++i];
+        if(flag == "--size") options.size = max(1, atoi(value.c_str()));
+        else if(flag == "--readers") options.readers = max(1, atoi(value.c_str()));
+        else if(flag == "--write-rate") options.write_rate = max(1, atoi(value.c_str()));
+        else if(flag == "--batch") options.batch = max(1, atoi(value.c_str()));
+        else if(flag == "--seconds") options.seconds = max(0.1, atof(value.c_str()));
+        else if(flag == "--mode" && (value == "live" || value == "rebuild" || value == "both")) options.mode = value;
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    cout << "Catalog of " << options.size << " keys, " << options.readers << " readers, "
+         << options.write_rate << " changes/s in batches of " << options.batch << ", "
+         << options.seconds << " s per mode" << endl;
+    if(options.mode != "rebuild") report("live", runLive(options), options);
+    if(options.mode != "live") report("rebuild", runRebuild(options), options);
+    return 0;
+}
@@ -0,0 +1,487 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace chrono;
+
+// Load generator for the API server. Every thread runs its own epoll loop
+// over a share of the keep-alive connections; a connection has at most one
+// request outstanding.
+//
+// Closed loop (--rate 0): each connection sends its next request as soon as
+// the previous response is complete, so throughput is whatever the server
+// sustains. Fixed rate (--rate R): requests are due at fixed intervals
+// whether or not earlier ones have been answered, and latency is measured
+// from when a request was due rather than when it went out. A stalled
+// server therefore shows up in the percentiles instead of silently slowing
+// the generator down (coordinated omission).
+
+struct LoadConfig {
+    string host = "127.0.0.1";
+    int port = 8080;
+    int connections = 64;
+    int threads = 1;
+    double seconds = 10;
+    double rate = 0;                // requests per second over all threads, 0 = closed loop
+    double drain_seconds = 2;       // how long requests open at the end may still finish
+    vector<string> paths;           // sent round-robin
+};
+
+struct ThreadStats {
+    vector<long long> latency_ns;   // from due time (fixed rate) or send time (closed loop)
+    vector<long long> service_ns;   // from send time
+    long long ok = 0;
+    long long http_errors = 0;      // 4xx and 5xx
+    long long status_503 = 0;
+    long long socket_errors = 0;    // refused, reset or malformed responses
+    long long unanswered = 0;       // sent, but no complete response by the end of the drain
+    long long not_sent = 0;         // due before the end but never sent
+    long long bytes = 0;
+};
+
+struct ClientConnection {
+    int fd = -1;
+    bool connected = false;
+    bool busy = false;
+    int failed_connects = 0;        // in a row, sets the reconnect backoff
+    steady_clock::time_point retry_at;
+    string out;
+    size_t out_sent = 0;
+    string in;
+    steady_clock::time_point due;
+    steady_clock::time_point sent;
+};
+
+// ==================== RESPONSE FRAMING ====================
+
+static bool startsWithIgnoreCase(string_view s, string_view prefix) {
+    if(s.size() < prefix.size()) return false;
+    for(size_t i = 0; i < prefix.size(); i++) {
+        if(tolower(static_cast<unsigned char>(s[i])) != prefix[i]) return false;
+    }
+    return true;
+}
+
+// Length of the first complete response in buf: 0 while incomplete, -1 when
+// malformed. Handles Content-Length and chunked bodies.
+static long completeResponse(string_view buf, int& status, bool& close) {
+    size_t head_end = buf.find("\r\n\r\n");
+    if(head_end == string_view::npos) return 0;
+    if(buf.size() < 12 || buf.compare(0, 5, "HTTP/") != 0) return -1;
+    status = atoi(string(buf.substr(9, 3)).c_str());
+
+    size_t content_length = 0;
+    bool chunked = false;
+    close = false;
+    size_t pos = buf.find("\r\n") + 2;
+    while(pos < head_end) {
+        size_t end = buf.find("\r\n", pos);
+        string_view line = buf.substr(pos, end - pos);
+        if(startsWithIgnoreCase(line, "content-length:")) content_length = strtoul(string(line.substr(15)).c_str(), nullptr, 10);
+        else if(startsWithIgnoreCase(line, "transfer-encoding:")) chunked = line.find("chunked") != string_view::npos;
+        else if(startsWithIgnoreCase(line, "connection:")) close = line.find("close") != string_view::npos;
+        pos = end + 2;
+    }
+
+    size_t body = head_end + 4;
+    if(!chunked) return buf.size() >= body + content_length ? static_cast<long>(body + content_length) : 0;
+
+    while(true) {
+        size_t line_end = buf.find("\r\n", body);
+        if(line_end == string_view::npos) return 0;
+        size_t size = strtoul(string(buf.substr(body, line_end - body)).c_str(), nullptr, 16);
+        size_t next = line_end + 2 + size + 2;
+        if(buf.size() < next) return 0;
+        if(size == 0) return static_cast<long>(next);
+        body = next;
+    }
+}
+
+// ==================== CLIENT LOOP ====================
+
+class LoadThread {
+public:
+    LoadThread(const LoadConfig& config, int connections, double rate, int id)
+        : config(config), connection_count(connections), rate(rate), next_path(id) {}
+
+    void run(steady_clock::time_point start, steady_clock::time_point stop, steady_clock::time_point deadline) {
+        epoll_fd = epoll_create1(0);
+        conns.resize(connection_count);
+        for(size_t i = 0; i < conns.size(); i++) open_connection(i);
+
+        auto interval = rate > 0 ? nanoseconds(static_cast<long long>(1e9 / rate)) : nanoseconds(0);
+        auto next_due = start;
+        epoll_event events[256];
+
+        while(true) {
+            auto now = steady_clock::now();
+            if(now >= stop) break;
+
+            if(rate > 0) {
+                while(next_due <= now) {
+                    due.push_back(next_due);
+                    next_due += interval;
+                }
+            }
+            reopen_due(now);
+            // Before start the connections only come up.
+            if(now >= start) dispatch(now);
+
+            int timeout_ms = 100;
+            if(now < start) {
+                timeout_ms = static_cast<int>(duration_cast<milliseconds>(start - now).count() + 1);
+            } else if(rate > 0) {
+                auto wait = duration_cast<microseconds>(min(next_due, stop) - steady_clock::now()).count();
+                timeout_ms = static_cast<int>(max<long long>(0, (wait + 999) / 1000));
+            }
+            auto retry = next_retry();
+            if(retry != steady_clock::time_point::max()) {
+                auto wait = duration_cast<milliseconds>(retry - steady_clock::now()).count() + 1;
+                timeout_ms = static_cast<int>(max<long long>(0, min<long long>(timeout_ms, wait)));
+            }
+            int n = epoll_wait(epoll_fd, events, 256, timeout_ms);
+            for(int e = 0; e < n; e++) handle_event(events[e].data.u32, events[e].events);
+        }
+
+        // No new requests from here on; the ones already sent get until the
+        // deadline to finish and are recorded like any other response.
+        draining = true;
+        while(true) {
+            auto now = steady_clock::now();
+            bool open = any_of(conns.begin(), conns.end(), [](const ClientConnection& c) { return c.busy; });
+            if(!open || now >= deadline) {
+                finished = now;
+                break;
+            }
+            auto wait = duration_cast<milliseconds>(deadline - now).count() + 1;
+            int n = epoll_wait(epoll_fd, events, 256, static_cast<int>(min<long long>(wait, 100)));
+            for(int e = 0; e < n; e++) handle_event(events[e].data.u32, events[e].events);
+        }
+
+        // Requests still open after that have waited at least until the
+        // deadline. Dropping them would hide exactly the slowest ones, so they
+        // count as failures and enter the percentiles with that lower bound.
+        for(auto& c : conns) {
+            if(!c.busy) continue;
+            stats.unanswered++;
+            stats.latency_ns.push_back(duration_cast<nanoseconds>(deadline - c.due).count());
+            stats.service_ns.push_back(duration_cast<nanoseconds>(deadline - c.sent).count());
+        }
+        for(auto d : due) stats.latency_ns.push_back(duration_cast<nanoseconds>(stop - d).count());
+        stats.not_sent += static_cast<long long>(due.size());
+        for(auto& c : conns) if(c.fd >= 0) ::close(c.fd);
+        ::close(epoll_fd);
+    }
+
+    ThreadStats stats;
+    steady_clock::time_point finished;  // when the drain ended, early if nothing was left open
+
+private:
+    void open_connection(size_t i) {
+        ClientConnection& c = conns[i];
+        int failed_connects = c.failed_connects;
+        c = ClientConnection();
+        c.failed_connects = failed_connects;
+        c.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        int one = 1;
+        setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(config.port));
+        inet_pton(AF_INET, config.host.c_str(), &addr.sin_addr);
+        if(connect(c.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 && errno != EINPROGRESS) {
+            stats.socket_errors++;
+            ::close(c.fd);
+            retry_later(i);
+            return;
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        ev.data.u32 = static_cast<uint32_t>(i);
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, c.fd, &ev);
+    }
+
+    void reconnect(size_t i) {
+        ClientConnection& c = conns[i];
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c.fd, nullptr);
+        ::close(c.fd);
+        bool was_busy = c.busy;
+        auto was_due = c.due;
+        if(c.connected) open_connection(i);
+        else retry_later(i);
+        // A request lost with its connection is retried with its original due time.
+        if(was_busy && rate > 0) due.push_front(was_due);
+    }
+
+    // A connection that failed before it ever connected (refused, backlog
+    // full) is opened again after a backoff that doubles from 1 ms to 1 s,
+    // instead of spinning on connect() against a server that is not there.
+    void retry_later(size_t i) {
+        ClientConnection& c = conns[i];
+        c.fd = -1;
+        c.connected = false;
+        c.busy = false;
+        c.retry_at = steady_clock::now() + milliseconds(1LL << min(c.failed_connects, 10));
+        c.failed_connects++;
+    }
+
+    void reopen_due(steady_clock::time_point now) {
+        for(size_t i = 0; i < conns.size(); i++) {
+            if(conns[i].fd < 0 && conns[i].retry_at <= now) open_connection(i);
+        }
+    }
+
+    steady_clock::time_point next_retry() const {
+        auto next = steady_clock::time_point::max();
+        for(const auto& c : conns) {
+            if(c.fd < 0) next = min(next, c.retry_at);
+        }
+        return next;
+    }
+
+    // Closed loop keeps every connected, idle connection busy; fixed rate
+    // hands out due requests oldest first.
+    void dispatch(steady_clock::time_point now) {
+        for(size_t i = 0; i < conns.size(); i++) {
+            ClientConnection& c = conns[i];
+            if(!c.connected || c.busy) continue;
+            if(rate > 0) {
+                if(due.empty()) return;
+                c.due = due.front();
+                due.pop_front();
+            } else {
+                c.due = now;
+            }
+            send_request(i);
+        }
+    }
+
+    void send_request(size_t i) {
+        ClientConnection& c = conns[i];
+        const string& path = config.paths[next_path++ % config.paths.size()];
+        c.out = "GET " + path + " HTTP/1.1\r\nHost: " + config.host + "\r\n\r\n";
+        c.out_sent = 0;
+        c.busy = true;
+        c.sent = steady_clock::now();
+        flush(i);
+    }
+
+    void flush(size_t i) {
+        ClientConnection& c = conns[i];
+        while(c.out_sent < c.out.size()) {
+            ssize_t n = ::send(c.fd, c.out.data() + c.out_sent, c.out.size() - c.out_sent, MSG_NOSIGNAL);
+            if(n > 0) {
+                c.out_sent += static_cast<size_t>(n);
+                continue;
+            }
+            if(n < 0 && errno == EINTR) continue;
+            if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            stats.socket_errors++;
+            reconnect(i);
+            return;
+        }
+    }
+
+    void handle_event(size_t i, uint32_t events) {
+        ClientConnection& c = conns[i];
+        if(events & (EPOLLERR | EPOLLHUP)) {
+            stats.socket_errors++;
+            reconnect(i);
+            return;
+        }
+        if((events & EPOLLOUT) && !c.connected) {
+            c.connected = true;
+            c.failed_connects = 0;
+        }
+        if(events & EPOLLOUT) flush(i);
+        if(!(events & EPOLLIN)) return;
+
+        char buffer[16384];
+        bool peer_closed = false;
+        while(true) {
+            ssize_t n = recv(c.fd, buffer, sizeof(buffer), 0);
+            if(n > 0) {
+                c.in.append(buffer, static_cast<size_t>(n));
+                stats.bytes += n;
+                continue;
+            }
+            if(n == 0) peer_closed = true;
+            else if(errno == EINTR) continue;
+            break;
+        }
+
+        int status = 0;
+        bool close = false;
+        long length = completeResponse(c.in, status, close);
+        if(length < 0) {
+            stats.socket_errors++;
+            reconnect(i);
+            return;
+        }
+        if(length > 0 && c.busy) {
+            auto now = steady_clock::now();
+            stats.latency_ns.push_back(duration_cast<nanoseconds>(now - c.due).count());
+            stats.service_ns.push_back(duration_cast<nanoseconds>(now - c.sent).count());
+            if(status >= 200 && status < 400) stats.ok++;
+            else stats.http_errors++;
+            if(status == 503) stats.status_503++;
+            c.in.erase(0, static_cast<size_t>(length));
+            c.busy = false;
+            if(close || peer_closed) {
+                reconnect(i);
+                return;
+            }
+            if(draining) return;
+            if(rate == 0) {
+                c.due = now;
+                send_request(i);
+            } else if(!due.empty()) {
+                c.due = due.front();
+                due.pop_front();
+                send_request(i);
+            }
+            return;
+        }
+        if(peer_closed) {
+            if(c.busy) stats.socket_errors++;
+            reconnect(i);
+        }
+    }
+
+    const LoadConfig& config;
+    int connection_count;
+    double rate;
+    size_t next_path;
+    int epoll_fd = -1;
+    bool draining = false;
+    vector<ClientConnection> conns;
+    deque<steady_clock::time_point> due;
+};
+
+// ==================== REPORT ====================
+
+static double percentileUs(const vector<long long>& sorted, double p) {
+    if(sorted.empty()) return 0;
+    size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[min(i, sorted.size() - 1)] / 1000.0;
+}
+
+static void printLatencies(const char* name, vector<long long> samples) {
+    sort(samples.begin(), samples.end());
+    cout << "  " << left << setw(10) << name << right << fixed << setprecision(1)
+         << " p50 " << setw(9) << percentileUs(samples, 0.50)
+         << "  p90 " << setw(9) << percentileUs(samples, 0.90)
+         << "  p99 " << setw(9) << percentileUs(samples, 0.99)
+         << "  p99.9 " << setw(9) << percentileUs(samples, 0.999)
+         << "  max " << setw(9) << percentileUs(samples, 1.0) << "  (us)" << endl;
+}
+
+static void printUsage(const char* prog) {
+    cerr << "Usage: " << prog << " [--host 127.0.0.1] [--port 8080] [--connections N] [--threads N]"
+         << " [--seconds S] [--drain-seconds S] [--rate requests/s] [--path /api/search?...]..." << endl
+         << "  --rate 0 (default) is closed loop; --path may be repeated and is sent round-robin" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    for(int i = 1; i < argc; i++) {
+        string flag = argv[i];
+        if(i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        string value = argv[++i];
+        if(flag == "--host") config.host = value;
+        else if(flag == "--port") config.port = atoi(value.c_str());
+        else if(flag == "--connections") config.connections = max(1, atoi(value.c_str()));
+        else if(flag == "--threads") config.threads = max(1, atoi(value.c_str()));
+        else if(flag == "--seconds") config.seconds = max(0.1, atof(value.c_str()));
+        else if(flag == "--drain-seconds") config.drain_seconds = max(0.0, atof(value.c_str()));
+        else if(flag == "--rate") config.rate = max(0.0, atof(value.c_str()));
+        else if(flag == "--path") config.paths.push_back(value);
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if(config.paths.empty()) {
+        config.paths = {"/api/search?size=10000&algorithm=iterative", "/api/batch?sizes=100,1000,10000"};
+    }
+    config.threads = min(config.threads, config.connections);
+
+    cout << (config.rate > 0 ? "Fixed rate " + to_string(static_cast<long long>(config.rate)) + " req/s"
+                             : string("Closed loop"))
+         << ", " << config.connections << " connections on " << config.threads << " threads, "
+         << config.seconds << " s against " << config.host << ":" << config.port << endl;
+    for(const auto& path : config.paths) cout << "  GET " << path << endl;
+
+    vector<unique_ptr<LoadThread>> loads;
+    for(int t = 0; t < config.threads; t++) {
+        int share = config.connections / config.threads + (t < config.connections % config.threads ? 1 : 0);
+        loads.push_back(make_unique<LoadThread>(config, share, config.rate / config.threads, t));
+    }
+
+    auto start = steady_clock::now() + milliseconds(50);    // let the connections come up
+    auto stop = start + duration_cast<nanoseconds>(duration<double>(config.seconds));
+    auto deadline = stop + duration_cast<nanoseconds>(duration<double>(config.drain_seconds));
+    vector<thread> threads;
+    for(auto& load : loads) {
+        threads.emplace_back([&load, start, stop, deadline]() { load->run(start, stop, deadline); });
+    }
+    for(auto& t : threads) t.join();
+
+    // Rates are over the time actually measured: the run plus whatever part
+    // of the drain was used, since responses from the drain are counted too.
+    auto finished = stop;
+    for(auto& load : loads) finished = max(finished, load->finished);
+    double elapsed = duration<double>(finished - start).count();
+
+    ThreadStats total;
+    for(auto& load : loads) {
+        ThreadStats& s = load->stats;
+        total.latency_ns.insert(total.latency_ns.end(), s.latency_ns.begin(), s.latency_ns.end());
+        total.service_ns.insert(total.service_ns.end(), s.service_ns.begin(), s.service_ns.end());
+        total.ok += s.ok;
+        total.http_errors += s.http_errors;
+        total.status_503 += s.status_503;
+        total.socket_errors += s.socket_errors;
+        total.unanswered += s.unanswered;
+        total.not_sent += s.not_sent;
+        total.bytes += s.bytes;
+    }
+
+    long long responses = total.ok + total.http_errors;
+    long long failures = total.http_errors + total.socket_errors + total.unanswered + total.not_sent;
+    long long attempts = responses + total.socket_errors + total.unanswered + total.not_sent;
+    cout << fixed << setprecision(1)
+         << "Requests: " << responses << " in " << setprecision(2) << elapsed << " s (" << setprecision(1)
+         << responses / elapsed << " req/s, " << total.bytes / elapsed / 1e6 << " MB/s received)" << endl
+         << "Errors: " << total.http_errors << " HTTP 4xx/5xx (" << total.status_503 << " x 503), "
+         << total.socket_errors << " socket, " << total.unanswered << " unanswered after the drain, "
+         << total.not_sent << " never sent | error rate " << setprecision(3)
+         << 100.0 * failures / max(1LL, attempts) << "%" << endl;
+    printLatencies(config.rate > 0 ? "response" : "latency", total.latency_ns);
+    if(config.rate > 0) printLatencies("service", total.service_ns);
+    return 0;
+}
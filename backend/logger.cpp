@@ -0,0 +1,283 @@
+#include "logger.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+const size_t TEXT_BYTES = 488;      // a slot is 512 bytes with its header
+const size_t BATCH_BYTES = 64 * 1024;
+
+struct Slot {
+    atomic<size_t> sequence;
+    long long timestamp_ns;
+    LogLevel level;
+    uint32_t length;
+    char text[TEXT_BYTES];
+};
+
+// Bounded MPMC ring after Vyukov: a slot is free for the producer claiming
+// position p when its sequence is p, and holds a line for the consumer when
+// it is p + 1. Only the writer thread consumes, so head needs no atomics.
+struct LoggerState {
+    vector<Slot> ring;
+    size_t mask = 0;
+    alignas(64) atomic<size_t> tail{0};
+    alignas(64) size_t head = 0;
+
+    LogLevel level = LogLevel::Info;
+    int sample_every = 1;
+    int fd = STDOUT_FILENO;
+    bool owns_fd = false;
+
+    atomic<bool> running{false};
+    thread writer;
+};
+
+// Never freed: a producer that read the pointer just before stop() may still
+// touch the ring afterwards.
+LoggerState* state = nullptr;
+atomic<LoggerState*> active{nullptr};
+mutex lifecycle_mutex;
+
+atomic<LogLevel> sync_level{LogLevel::Info};
+atomic<long long> dropped_lines{0};
+atomic<long long> sampled_lines{0};
+
+const char* shortLevelName(LogLevel level) {
+    switch(level) {
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO ";
+        case LogLevel::Warn: return "WARN ";
+        default: return "ERROR";
+    }
+}
+
+long long nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void writeAll(int fd, const char* data, size_t size) {
+    while(size > 0) {
+        ssize_t n = write(fd, data, size);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+// "2026-01-31T12:00:00.123Z INFO  text\n"
+void appendLine(string& out, long long timestamp_ns, LogLevel level, const char* text, size_t length) {
+    time_t seconds = static_cast<time_t>(timestamp_ns / 1000000000);
+    int millis = static_cast<int>((timestamp_ns / 1000000) % 1000);
+    tm utc;
+    gmtime_r(&seconds, &utc);
+    char prefix[48];
+    size_t n = strftime(prefix, sizeof(prefix), "%Y-%m-%dT%H:%M:%S", &utc);
+    n += snprintf(prefix + n, sizeof(prefix) - n, ".%03dZ %s ", millis, shortLevelName(level));
+    out.append(prefix, n);
+    out.append(text, length);
+    out += '\n';
+}
+
+void writerLoop(LoggerState* s) {
+    string batch;
+    batch.reserve(BATCH_BYTES + 512);
+
+    while(true) {
+        bool stopping = !s->running.load(memory_order_acquire);
+
+        while(batch.size() < BATCH_BYTES) {
+            Slot& slot = s->ring[s->head & s->mask];
+            if(slot.sequence.load(memory_order_acquire) != s->head + 1) break;
+            appendLine(batch, slot.timestamp_ns, slot.level, slot.text, slot.length);
+            slot.sequence.store(s->head + s->ring.size(), memory_order_release);
+            s->head++;
+        }
+
+        if(!batch.empty()) {
+            writeAll(s->fd, batch.data(), batch.size());
+            batch.clear();
+            continue;   // there may be more queued behind a full batch
+        }
+        if(stopping) return;
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+}
+
+bool passes(LogLevel level, LogLevel threshold, int sample_every) {
+    if(level < threshold || threshold == LogLevel::Off) return false;
+    if(level >= LogLevel::Warn || sample_every <= 1) return true;
+    thread_local unsigned long long seen = 0;
+    if(seen++ % static_cast<unsigned long long>(sample_every) == 0) return true;
+    sampled_lines.fetch_add(1, memory_order_relaxed);
+    return false;
+}
+
+void vlog(LogLevel level, const char* fmt, va_list args) {
+    LoggerState* s = active.load(memory_order_acquire);
+    if(!s) {
+        if(level < sync_level.load(memory_order_relaxed)) return;
+        char text[1024];
+        int n = vsnprintf(text, sizeof(text), fmt, args);
+        if(n < 0) return;
+        string line;
+        appendLine(line, nowNs(), level, text, min(static_cast<size_t>(n), sizeof(text) - 1));
+        writeAll(STDOUT_FILENO, line.data(), line.size());
+        return;
+    }
+    if(!passes(level, s->level, s->sample_every)) return;
+
+    size_t pos = s->tail.load(memory_order_relaxed);
+    Slot* slot;
+    while(true) {
+        slot = &s->ring[pos & s->mask];
+        size_t sequence = slot->sequence.load(memory_order_acquire);
+        long long diff = static_cast<long long>(sequence) - static_cast<long long>(pos);
+        if(diff == 0) {
+            if(s->tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+        } else if(diff < 0) {
+            dropped_lines.fetch_add(1, memory_order_relaxed);   // ring full
+            return;
+        } else {
+            pos = s->tail.load(memory_order_relaxed);
+        }
+    }
+
+    int n = vsnprintf(slot->text, TEXT_BYTES, fmt, args);
+    slot->length = static_cast<uint32_t>(n < 0 ? 0 : min(static_cast<size_t>(n), TEXT_BYTES - 1));
+    slot->level = level;
+    slot->timestamp_ns = nowNs();
+    slot->sequence.store(pos + 1, memory_order_release);
+}
+
+} // namespace
+
+void Logger::start(const LoggerConfig& config) {
+    lock_guard<mutex> lock(lifecycle_mutex);
+    if(active.load()) return;
+
+    if(!state) {
+        size_t capacity = 2;
+        while(capacity < config.capacity) capacity <<= 1;
+        state = new LoggerState();
+        state->ring = vector<Slot>(capacity);
+        state->mask = capacity - 1;
+    }
+    // stop() left the ring drained, so a restart can begin from position 0.
+    state->head = 0;
+    state->tail.store(0, memory_order_relaxed);
+    for(size_t i = 0; i < state->ring.size(); i++) {
+        state->ring[i].sequence.store(i, memory_order_relaxed);
+    }
+
+    state->level = config.level;
+    state->sample_every = max(1, config.sample_every);
+    state->fd = STDOUT_FILENO;
+    state->owns_fd = false;
+    if(!config.path.empty()) {
+        int fd = open(config.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if(fd >= 0) {
+            state->fd = fd;
+            state->owns_fd = true;
+        } else {
+            fprintf(stderr, "Cannot open log file %s: %s, logging to stdout\n",
+                    config.path.c_str(), strerror(errno));
+        }
+    }
+
+    sync_level.store(config.level, memory_order_relaxed);
+    state->running.store(true, memory_order_release);
+    state->writer = thread(writerLoop, state);
+    active.store(state, memory_order_release);
+}
+
+void Logger::stop() {
+    lock_guard<mutex> lock(lifecycle_mutex);
+    LoggerState* s = active.exchange(nullptr);
+    if(!s) return;
+
+    s->running.store(false, memory_order_release);
+    s->writer.join();
+    if(s->owns_fd) close(s->fd);
+    s->fd = STDOUT_FILENO;
+    s->owns_fd = false;
+}
+
+bool Logger::enabled(LogLevel level) {
+    LoggerState* s = active.load(memory_order_acquire);
+    LogLevel threshold = s ? s->level : sync_level.load(memory_order_relaxed);
+    return threshold != LogLevel::Off && level >= threshold;
+}
+
+void Logger::debug(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vlog(LogLevel::Debug, fmt, args);
+    va_end(args);
+}
+
+void Logger::info(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vlog(LogLevel::Info, fmt, args);
+    va_end(args);
+}
+
+void Logger::warn(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vlog(LogLevel::Warn, fmt, args);
+    va_end(args);
+}
+
+void Logger::error(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vlog(LogLevel::Error, fmt, args);
+    va_end(args);
+}
+
+long long Logger::dropped() {
+    return dropped_lines.load(memory_order_relaxed);
+}
+
+long long Logger::sampledOut() {
+    return sampled_lines.load(memory_order_relaxed);
+}
+
+bool Logger::parseLevel(const string& name, LogLevel& level) {
+    if(name == "debug") level = LogLevel::Debug;
+    else if(name == "info") level = LogLevel::Info;
+    else if(name == "warn") level = LogLevel::Warn;
+    else if(name == "error") level = LogLevel::Error;
+    else if(name == "off") level = LogLevel::Off;
+    else return false;
+    return true;
+}
+
+const char* Logger::levelName(LogLevel level) {
+    switch(level) {
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Info: return "info";
+        case LogLevel::Warn: return "warn";
+        case LogLevel::Error: return "error";
+        default: return "off";
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <string>
+#include <cstddef>
+
+enum class LogLevel {
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+struct LoggerConfig {
+    LogLevel level = LogLevel::Info;
+    int sample_every = 1;       // keep 1 in N debug/info lines per thread; warnings always pass
+    std::string path;           // empty = stdout
+    size_t capacity = 8192;     // ring slots, rounded up to a power of two
+};
+
+// Asynchronous line logger. Producers format into a slot of a bounded
+// lock-free multi-producer ring and return; a background thread drains the
+// ring in batches with one write() per batch. When the ring is full the line
+// is dropped and counted instead of blocking the caller. Lines longer than a
+// slot are truncated. Before start() (and after stop()) lines are written
+// synchronously to stdout, so tools that never start the logger still print.
+class Logger {
+public:
+    static void start(const LoggerConfig& config = LoggerConfig());
+    static void stop();     // drains what is queued, then joins the writer thread
+
+    static bool enabled(LogLevel level);
+    static void debug(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+    static void info(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+    static void warn(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+    static void error(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+    static long long dropped();
+    static long long sampledOut();
+
+    static bool parseLevel(const std::string& name, LogLevel& level);
+    static const char* levelName(LogLevel level);
+};
+
+#endif
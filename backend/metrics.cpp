@@ -0,0 +1,235 @@
+#include "metrics.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <charconv>
+
+using namespace std;
+
+namespace {
+
+const int ENDPOINTS = static_cast<int>(Endpoint::Count);
+const int PHASES = static_cast<int>(Phase::Count);
+
+const int SUB_BITS = 2;                                 // 4 buckets per power of two
+const int MIN_SHIFT = 8;                                // first bucket: <= 256 ns
+const int MAX_SHIFT = 35;                               // last finite bucket ends at ~34 s
+const int FINITE_BUCKETS = 1 + (MAX_SHIFT - MIN_SHIFT) * (1 << SUB_BITS);
+const int BUCKETS = FINITE_BUCKETS + 1;                 // plus overflow
+
+// Buckets include their upper bound, like Prometheus' le: bucket b holds
+// (bucketUpperNs(b - 1), bucketUpperNs(b)]. Shifting by one maps that onto
+// the half-open ranges the bit arithmetic works with.
+int bucketFor(long long ns) {
+    if(ns <= (1LL << MIN_SHIFT)) return 0;
+    unsigned long long below = static_cast<unsigned long long>(ns - 1);
+    int msb = 63 - __builtin_clzll(below);
+    if(msb >= MAX_SHIFT) return FINITE_BUCKETS;
+    int sub = static_cast<int>((below >> (msb - SUB_BITS)) & ((1 << SUB_BITS) - 1));
+    return 1 + (msb - MIN_SHIFT) * (1 << SUB_BITS) + sub;
+}
+
+// Inclusive upper bound of a finite bucket in nanoseconds.
+long long bucketUpperNs(int bucket) {
+    if(bucket == 0) return 1LL << MIN_SHIFT;
+    int msb = MIN_SHIFT + (bucket - 1) / (1 << SUB_BITS);
+    int sub = (bucket - 1) % (1 << SUB_BITS);
+    return static_cast<long long>((1 << SUB_BITS) + sub + 1) << (msb - SUB_BITS);
+}
+
+// Written only by the owning thread, so an increment is a relaxed load and
+// store instead of a locked read-modify-write; render() reads concurrently.
+struct Counter {
+    atomic<long long> value{0};
+
+    void add(long long n) { value.store(value.load(memory_order_relaxed) + n, memory_order_relaxed); }
+    long long get() const { return value.load(memory_order_relaxed); }
+};
+
+struct Histogram {
+    Counter buckets[BUCKETS];
+    Counter count;
+    Counter sum_ns;
+};
+
+struct Shard {
+    Counter started[ENDPOINTS];
+    Counter finished[ENDPOINTS];
+    Counter errors[ENDPOINTS];
+    Histogram phases[ENDPOINTS][PHASES];
+};
+
+// Shards outlive their threads so counts survive thread exit; threads here
+// are long-lived, so the registry only grows by one shard per thread.
+mutex registry_mutex;
+vector<unique_ptr<Shard>> registry;
+
+Shard& localShard() {
+    thread_local Shard* shard = nullptr;
+    if(!shard) {
+        auto created = make_unique<Shard>();
+        shard = created.get();
+        lock_guard<mutex> lock(registry_mutex);
+        registry.push_back(move(created));
+    }
+    return *shard;
+}
+
+void appendNumber(string& out, long long v) {
+    char buf[24];
+    auto res = to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+void appendNumber(string& out, double v) {
+    char buf[32];
+    auto res = to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+void appendHeader(string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void appendEndpointSample(string& out, const char* name, int endpoint, long long v) {
+    out += name;
+    out += "{endpoint=\"";
+    out += Metrics::endpointName(static_cast<Endpoint>(endpoint));
+    out += "\"} ";
+    appendNumber(out, v);
+    out += '\n';
+}
+
+} // namespace
+
+Endpoint Metrics::endpointFor(string_view method, string_view path) {
+    if(method != "GET") return Endpoint::Other;
+    if(path == "/api/health") return Endpoint::Health;
+    if(path == "/api/complexity") return Endpoint::Complexity;
+    if(path == "/api/metrics") return Endpoint::Metrics;
+    if(path == "/api/search") return Endpoint::Search;
+    if(path == "/api/batch") return Endpoint::Batch;
+    if(path == "/api/multisearch") return Endpoint::MultiSearch;
+    return Endpoint::Other;
+}
+
+const char* Metrics::endpointName(Endpoint endpoint) {
+    switch(endpoint) {
+        case Endpoint::Health: return "health";
+        case Endpoint::Search: return "search";
+        case Endpoint::Batch: return "batch";
+        case Endpoint::MultiSearch: return "multisearch";
+        case Endpoint::Complexity: return "complexity";
+        case Endpoint::Metrics: return "metrics";
+        default: return "other";
+    }
+}
+
+const char* Metrics::phaseName(Phase phase) {
+    switch(phase) {
+        case Phase::Parse: return "parse";
+        case Phase::Generate: return "generate";
+        case Phase::Search: return "search";
+        case Phase::Send: return "send";
+        default: return "total";
+    }
+}
+
+void Metrics::requestStarted(Endpoint endpoint) {
+    localShard().started[static_cast<int>(endpoint)].add(1);
+}
+
+void Metrics::requestFinished(Endpoint endpoint, bool error) {
+    Shard& shard = localShard();
+    shard.finished[static_cast<int>(endpoint)].add(1);
+    if(error) shard.errors[static_cast<int>(endpoint)].add(1);
+}
+
+void Metrics::recordPhase(Endpoint endpoint, Phase phase, long long ns) {
+    if(ns < 0) ns = 0;
+    Histogram& h = localShard().phases[static_cast<int>(endpoint)][static_cast<int>(phase)];
+    h.buckets[bucketFor(ns)].add(1);
+    h.count.add(1);
+    h.sum_ns.add(ns);
+}
+
+void Metrics::render(string& out) {
+    // Sum the shards first; the totals are plain numbers from here on.
+    struct Totals {
+        long long started[ENDPOINTS] = {};
+        long long finished[ENDPOINTS] = {};
+        long long errors[ENDPOINTS] = {};
+        long long buckets[ENDPOINTS][PHASES][BUCKETS] = {};
+        long long count[ENDPOINTS][PHASES] = {};
+        long long sum_ns[ENDPOINTS][PHASES] = {};
+    };
+    auto totals = make_unique<Totals>();
+    {
+        lock_guard<mutex> lock(registry_mutex);
+        for(const auto& shard : registry) {
+            for(int e = 0; e < ENDPOINTS; e++) {
+                totals->started[e] += shard->started[e].get();
+                totals->finished[e] += shard->finished[e].get();
+                totals->errors[e] += shard->errors[e].get();
+                for(int p = 0; p < PHASES; p++) {
+                    const Histogram& h = shard->phases[e][p];
+                    for(int b = 0; b < BUCKETS; b++) totals->buckets[e][p][b] += h.buckets[b].get();
+                    totals->count[e][p] += h.count.get();
+                    totals->sum_ns[e][p] += h.sum_ns.get();
+                }
+            }
+        }
+    }
+
+    appendHeader(out, "linear_search_requests_total", "counter", "Requests received, by endpoint.");
+    for(int e = 0; e < ENDPOINTS; e++) appendEndpointSample(out, "linear_search_requests_total", e, totals->started[e]);
+
+    appendHeader(out, "linear_search_errors_total", "counter", "Responses with a 4xx or 5xx status, by endpoint.");
+    for(int e = 0; e < ENDPOINTS; e++) appendEndpointSample(out, "linear_search_errors_total", e, totals->errors[e]);
+
+    appendHeader(out, "linear_search_requests_in_flight", "gauge", "Requests received but not yet fully answered.");
+    for(int e = 0; e < ENDPOINTS; e++) {
+        appendEndpointSample(out, "linear_search_requests_in_flight", e, totals->started[e] - totals->finished[e]);
+    }
+
+    // Only series that have seen a sample are written; buckets are cumulative.
+    appendHeader(out, "linear_search_phase_seconds", "histogram", "Latency of each request phase, by endpoint.");
+    for(int e = 0; e < ENDPOINTS; e++) {
+        for(int p = 0; p < PHASES; p++) {
+            if(totals->count[e][p] == 0) continue;
+
+            string labels = "endpoint=\"";
+            labels += endpointName(static_cast<Endpoint>(e));
+            labels += "\",phase=\"";
+            labels += phaseName(static_cast<Phase>(p));
+            labels += '"';
+
+            long long cumulative = 0;
+            for(int b = 0; b < BUCKETS; b++) {
+                cumulative += totals->buckets[e][p][b];
+                out += "linear_search_phase_seconds_bucket{";
+                out += labels;
+                out += ",le=\"";
+                if(b < FINITE_BUCKETS) appendNumber(out, bucketUpperNs(b) / 1e9);
+                else out += "+Inf";
+                out += "\"} ";
+                appendNumber(out, cumulative);
+                out += '\n';
+            }
+            out += "linear_search_phase_seconds_sum{" + labels + "} ";
+            appendNumber(out, totals->sum_ns[e][p] / 1e9);
+            out += "\nlinear_search_phase_seconds_count{" + labels + "} ";
+            appendNumber(out, totals->count[e][p]);
+            out += '\n';
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+enum class Endpoint {
+    Health,
+    Search,
+    Batch,
+    MultiSearch,
+    Complexity,
+    Metrics,
+    Other,      // unknown paths, preflight requests, malformed input
+    Count
+};
+
+enum class Phase {
+    Parse,      // locating and parsing the request head
+    Generate,   // fetching (and on a miss building) the dataset
+    Search,     // the timed search itself
+    Send,       // response ready until its last byte was written
+    Total,      // request parsed until its last byte was written
+    Count
+};
+
+// Request counters and latency histograms for /api/metrics.
+//
+// Every thread records into its own shard, so recording is a handful of
+// relaxed atomic stores and never contends; only render() walks all shards.
+// Histograms are log-linear like HDR histograms: four buckets per power of
+// two between 256 ns and ~34 s, i.e. about 25% relative resolution.
+class Metrics {
+public:
+    // Matches exact paths like the router, so unknown paths count as Other.
+    static Endpoint endpointFor(std::string_view method, std::string_view path);
+    static const char* endpointName(Endpoint endpoint);
+    static const char* phaseName(Phase phase);
+
+    static void requestStarted(Endpoint endpoint);
+    static void requestFinished(Endpoint endpoint, bool error);
+    static void recordPhase(Endpoint endpoint, Phase phase, long long ns);
+
+    // Appends all metrics in the Prometheus text exposition format.
+    static void render(std::string& out);
+};
+
+#endif
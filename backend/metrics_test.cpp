@@ -0,0 +1,44 @@
+#include "metrics.h"
+#include "test_check.h"
+#include <string>
+
+using namespace std;
+
+static void testEndpointsMatchExactPaths() {
+    CHECK(Metrics::endpointFor("GET", "/api/search") == Endpoint::Search);
+    CHECK(Metrics::endpointFor("GET", "/api/batch") == Endpoint::Batch);
+    CHECK(Metrics::endpointFor("GET", "/api/multisearch") == Endpoint::MultiSearch);
+    CHECK(Metrics::endpointFor("GET", "/api/searchx") == Endpoint::Other);
+    CHECK(Metrics::endpointFor("GET", "/api/search/foo") == Endpoint::Other);
+    CHECK(Metrics::endpointFor("GET", "/api/batchy") == Endpoint::Other);
+    CHECK(Metrics::endpointFor("POST", "/api/search") == Endpoint::Other);
+}
+
+// Cumulative count of the search/total bucket with the given le label, or -1.
+static long long bucketCount(const string& text, const string& le) {
+    string prefix = "linear_search_phase_seconds_bucket{endpoint=\"search\",phase=\"total\",le=\"" + le + "\"} ";
+    size_t at = text.find(prefix);
+    if(at == string::npos) return -1;
+    return stoll(text.substr(at + prefix.size()));
+}
+
+// A sample equal to a bucket's upper bound is counted in that bucket.
+static void testBucketBoundsAreInclusive() {
+    Metrics::recordPhase(Endpoint::Search, Phase::Total, 0);
+    Metrics::recordPhase(Endpoint::Search, Phase::Total, 256);
+    Metrics::recordPhase(Endpoint::Search, Phase::Total, 257);
+    Metrics::recordPhase(Endpoint::Search, Phase::Total, 320);
+    Metrics::recordPhase(Endpoint::Search, Phase::Total, 321);
+
+    string text;
+    Metrics::render(text);
+    CHECK(bucketCount(text, "2.56e-07") == 2);
+    CHECK(bucketCount(text, "3.2e-07") == 4);
+    CHECK(bucketCount(text, "+Inf") == 5);
+}
+
+int main() {
+    testEndpointsMatchExactPaths();
+    testBucketBoundsAreInclusive();
+    return testResult("metrics_test");
+}
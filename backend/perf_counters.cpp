@@ -0,0 +1,152 @@
+#include "perf_counters.h"
+#include <atomic>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static atomic<bool> perf_enabled(false);
+
+void PerfCounters::setEnabled(bool on) {
+    perf_enabled.store(on, memory_order_relaxed);
+}
+
+bool PerfCounters::enabled() {
+    return perf_enabled.load(memory_order_relaxed);
+}
+
+#ifdef __linux__
+
+namespace {
+
+struct EventSpec {
+    uint32_t type;
+    uint64_t config;
+    long long PerfCounterValues::*field;
+};
+
+const EventSpec EVENTS[] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, &PerfCounterValues::cycles},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, &PerfCounterValues::instructions},
+    {PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+     &PerfCounterValues::l1d_misses},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, &PerfCounterValues::llc_misses},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, &PerfCounterValues::branch_misses},
+};
+
+// All events of one thread, opened as a single group so they are scheduled
+// together and read with one syscall.
+struct ThreadCounters {
+    bool opened = false;
+    int leader = -1;
+    vector<int> fds;
+    vector<long long PerfCounterValues::*> fields;
+    string status = "not opened";
+
+    ~ThreadCounters() {
+        for(int fd : fds) close(fd);
+    }
+
+    void open() {
+        opened = true;
+        int first_errno = 0;
+
+        for(const auto& event : EVENTS) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = event.type;
+            attr.config = event.config;
+            attr.disabled = (leader == -1);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+            if(fd < 0) {
+                if(first_errno == 0) first_errno = errno;
+                continue;   // this event is unsupported; keep the others
+            }
+            if(leader == -1) leader = fd;
+            fds.push_back(fd);
+            fields.push_back(event.field);
+        }
+
+        if(leader == -1) {
+            status = string("perf_event_open failed: ") + strerror(first_errno);
+        } else {
+            status = "ok";
+        }
+    }
+};
+
+thread_local ThreadCounters thread_counters;
+
+}
+
+string PerfCounters::status() {
+    if(!enabled()) return "disabled";
+    if(!thread_counters.opened) thread_counters.open();
+    return thread_counters.status;
+}
+
+PerfScope::PerfScope() : active(false) {
+    if(!PerfCounters::enabled()) return;
+
+    ThreadCounters& tc = thread_counters;
+    if(!tc.opened) tc.open();
+    if(tc.leader == -1) return;
+
+    ioctl(tc.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(tc.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    active = true;
+}
+
+PerfCounterValues PerfScope::stop() {
+    PerfCounterValues values;
+    if(!active) return values;
+    active = false;
+
+    ThreadCounters& tc = thread_counters;
+    ioctl(tc.leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // Layout for PERF_FORMAT_GROUP with both times: nr, enabled, running, value[nr].
+    vector<uint64_t> buffer(3 + tc.fds.size());
+    ssize_t bytes = read(tc.leader, buffer.data(), buffer.size() * sizeof(uint64_t));
+    if(bytes < static_cast<ssize_t>(3 * sizeof(uint64_t))) return values;
+
+    uint64_t count = buffer[0];
+    uint64_t time_running = buffer[2];
+    if(time_running == 0) return values;   // the PMU never scheduled the group
+
+    for(size_t i = 0; i < count && i < tc.fields.size(); i++) {
+        values.*(tc.fields[i]) = static_cast<long long>(buffer[3 + i]);
+    }
+    values.available = true;
+    return values;
+}
+
+#else
+
+string PerfCounters::status() {
+    return enabled() ? "perf_event_open is Linux only" : "disabled";
+}
+
+PerfScope::PerfScope() : active(false) {}
+
+PerfCounterValues PerfScope::stop() {
+    return PerfCounterValues();
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <string>
+
+// Hardware counters for one search. -1 means that event could not be
+// counted (not enabled, not permitted, or not supported by the PMU).
+struct PerfCounterValues {
+    bool available = false;
+    long long cycles = -1;
+    long long instructions = -1;
+    long long l1d_misses = -1;
+    long long llc_misses = -1;
+    long long branch_misses = -1;
+};
+
+// Process-wide switch for the perf_event_open instrumentation. Counters are
+// opened lazily per thread, user space only, and stay open for the thread's
+// lifetime. When the kernel refuses them (perf_event_paranoid, containers,
+// VMs without a virtual PMU) searches run normally and report -1.
+class PerfCounters {
+public:
+    static void setEnabled(bool on);
+    static bool enabled();
+
+    // "disabled", "ok", or why the counters are unavailable on this thread.
+    static std::string status();
+};
+
+// Counts events on the calling thread from construction until stop().
+// Costs a single flag check while the instrumentation is disabled.
+class PerfScope {
+public:
+    PerfScope();
+    PerfCounterValues stop();
+
+private:
+    bool active;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "request_coalescer.h"
+#include <functional>
+
+using namespace std;
+using namespace chrono;
+
+RequestCoalescer::RequestCoalescer(milliseconds ttl, size_t max_entries)
+    : ttl(max(ttl, milliseconds(0))), max_entries_per_shard(max<size_t>(1, max_entries / SHARDS)),
+      hits(0), misses(0), coalesced(0) {}
+
+RequestCoalescer::Shard& RequestCoalescer::shardFor(const RequestKey& key) {
+    return shards[hash<string_view>()(key.view()) % SHARDS];
+}
+
+void RequestCoalescer::runShared(const RequestKey& key, string& out, void* context,
+                                 void (*compute)(void*, string&)) {
+    Shard& shard = shardFor(key);
+
+    unique_lock<mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if(it != shard.entries.end() && it->second.ready && steady_clock::now() >= it->second.expires) {
+        shard.entries.erase(it);
+        it = shard.entries.end();
+    }
+    if(it != shard.entries.end()) {
+        Entry& entry = it->second;
+        if(entry.ready) {
+            hits++;
+            ResultPtr body = entry.body;
+            lock.unlock();
+            out += *body;
+            return;
+        }
+        coalesced++;
+        if(!entry.waiting) {
+            entry.waiting.emplace();
+            entry.joined = entry.waiting->get_future().share();
+        }
+        shared_future<ResultPtr> pending = entry.joined;
+        lock.unlock();
+        out += *pending.get();  // waits until the first request is done
+        return;
+    }
+
+    // Only this request erases its entry until it is ready, so it stays valid.
+    misses++;
+    it = shard.entries.emplace(key, Entry()).first;
+    lock.unlock();
+
+    string body;
+    try {
+        compute(context, body);
+    } catch(...) {
+        lock.lock();
+        if(it->second.waiting) it->second.waiting->set_exception(current_exception());
+        shard.entries.erase(it);
+        throw;
+    }
+
+    lock.lock();
+    Entry& entry = it->second;
+    auto now = steady_clock::now();
+    if(shard.entries.size() > max_entries_per_shard) eraseExpired(shard, now);
+    bool keep = ttl.count() > 0 && shard.entries.size() <= max_entries_per_shard;
+
+    if(!entry.waiting && !keep) {
+        shard.entries.erase(it);
+        lock.unlock();
+        if(out.empty()) out = move(body);
+        else out += body;
+        return;
+    }
+
+    ResultPtr result = make_shared<const string>(move(body));
+    if(entry.waiting) entry.waiting->set_value(result);
+    if(keep) {
+        entry.waiting.reset();
+        entry.joined = shared_future<ResultPtr>();
+        entry.body = result;
+        entry.ready = true;
+        entry.expires = now + ttl;
+    } else {
+        shard.entries.erase(it);
+    }
+    lock.unlock();
+    out += *result;
+}
+
+// Called with the shard's mutex held; entries still computing are never expired.
+void RequestCoalescer::eraseExpired(Shard& shard, steady_clock::time_point now) {
+    for(auto it = shard.entries.begin(); it != shard.entries.end();) {
+        if(it->second.ready && now >= it->second.expires) it = shard.entries.erase(it);
+        else ++it;
+    }
+}
+
+RequestCoalescerStats RequestCoalescer::stats() const {
+    RequestCoalescerStats s;
+    s.hits = hits.load();
+    s.misses = misses.load();
+    s.coalesced = coalesced.load();
+    s.entries = 0;
+    for(Shard& shard : shards) {
+        lock_guard<mutex> lock(shard.mutex);
+        s.entries += static_cast<long long>(shard.entries.size());
+    }
+    s.ttl_ms = static_cast<long long>(ttl.count());
+    return s;
+}
@@ -0,0 +1,118 @@
+#ifndef REQUEST_COALESCER_H
+#define REQUEST_COALESCER_H
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <charconv>
+#include <type_traits>
+
+struct RequestCoalescerStats {
+    long long hits;         // answered from a finished result still within its TTL
+    long long misses;       // computed
+    long long coalesced;    // waited for an identical request already computing
+    long long entries;
+    long long ttl_ms;
+};
+
+// Normalised request parameters, built in place without allocating. A key
+// longer than its buffer is invalid and is never shared.
+class RequestKey {
+public:
+    RequestKey& add(std::string_view text) {
+        if(text.size() > sizeof(bytes) - length) {
+            overflow = true;
+            return *this;
+        }
+        text.copy(bytes + length, text.size());
+        length += text.size();
+        return *this;
+    }
+
+    RequestKey& add(long long value) {
+        auto res = std::to_chars(bytes + length, bytes + sizeof(bytes), value);
+        if(res.ec != std::errc()) overflow = true;
+        else length = static_cast<size_t>(res.ptr - bytes);
+        return *this;
+    }
+
+    std::string_view view() const { return std::string_view(bytes, length); }
+    bool valid() const { return !overflow; }
+    bool operator<(const RequestKey& other) const { return view() < other.view(); }
+
+private:
+    char bytes[64];
+    size_t length = 0;
+    bool overflow = false;
+};
+
+// Single-flight deduplication of response bodies by RequestKey.
+// The first request for a key computes the body; identical requests that
+// arrive while it runs wait for it and get the same body. With a TTL the
+// finished body is kept that long and served to later requests as well;
+// with a TTL of 0 it is dropped as soon as it is done. About max_entries
+// finished bodies are kept. A compute that throws is rethrown to everyone
+// waiting on it and nothing is kept.
+//
+// Every request registers its key before computing, so a second one can
+// join it. Entries are spread over shards with a lock each; a request that
+// nobody joins costs one map insert and moves its body straight to the
+// caller. Invalid keys are never registered and always compute.
+class RequestCoalescer {
+public:
+    explicit RequestCoalescer(std::chrono::milliseconds ttl, size_t max_entries = 4096);
+
+    // Appends the body for key to out. compute(std::string& body) appends a
+    // freshly computed body to body.
+    template<typename Compute>
+    void run(const RequestKey& key, std::string& out, Compute&& compute) {
+        if(!key.valid()) {
+            misses++;
+            compute(out);
+            return;
+        }
+        runShared(key, out, &compute, [](void* c, std::string& body) {
+            (*static_cast<std::remove_reference_t<Compute>*>(c))(body);
+        });
+    }
+
+    RequestCoalescerStats stats() const;
+
+private:
+    using ResultPtr = std::shared_ptr<const std::string>;
+    static constexpr size_t SHARDS = 16;
+
+    struct Entry {
+        std::optional<std::promise<ResultPtr>> waiting; // made when the first identical request joins
+        std::shared_future<ResultPtr> joined;
+        ResultPtr body;                                 // set once finished and kept for the TTL
+        bool ready = false;                             // false while the first request computes
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::map<RequestKey, Entry> entries;
+    };
+
+    Shard& shardFor(const RequestKey& key);
+    void runShared(const RequestKey& key, std::string& out, void* context,
+                   void (*compute)(void*, std::string&));
+    static void eraseExpired(Shard& shard, std::chrono::steady_clock::time_point now);
+
+    std::chrono::milliseconds ttl;
+    size_t max_entries_per_shard;
+    mutable Shard shards[SHARDS];
+
+    std::atomic<long long> hits;
+    std::atomic<long long> misses;
+    std::atomic<long long> coalesced;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "request_coalescer.h"
+#include "test_check.h"
+#include <thread>
+#include <stdexcept>
+
+using namespace std;
+using namespace chrono;
+
+// Spins until pred holds or a few seconds pass; returns pred().
+template<typename Pred>
+static bool waitFor(Pred pred) {
+    auto deadline = steady_clock::now() + seconds(5);
+    while(!pred() && steady_clock::now() < deadline) this_thread::sleep_for(milliseconds(1));
+    return pred();
+}
+
+static RequestKey makeKey(long long size) {
+    RequestKey key;
+    key.add("search ").add(size);
+    return key;
+}
+
+// A second identical request that arrives while the first computes waits for
+// it instead of computing again.
+static void testConcurrentRequestsComputeOnce() {
+    RequestCoalescer coalescer(milliseconds(0));
+    atomic<int> computes(0);
+    atomic<bool> started(false);
+    string first, second;
+
+    thread leader([&]() {
+        coalescer.run(makeKey(100), first, [&](string& body) {
+            computes++;
+            started = true;
+            waitFor([&]() { return coalescer.stats().coalesced == 1; });
+            body += "body";
+        });
+    });
+    CHECK(waitFor([&]() { return started.load(); }));
+    thread follower([&]() {
+        coalescer.run(makeKey(100), second, [&](string& body) {
+            computes++;
+            body += "other";
+        });
+    });
+    leader.join();
+    follower.join();
+
+    RequestCoalescerStats s = coalescer.stats();
+    CHECK(computes == 1);
+    CHECK(first == "body");
+    CHECK(second == "body");
+    CHECK(s.misses == 1);
+    CHECK(s.coalesced == 1);
+    CHECK(s.entries == 0);
+}
+
+static void testTtl() {
+    RequestCoalescer none(milliseconds(0));
+    int computes = 0;
+    string out;
+    for(int i = 0; i < 2; i++) none.run(makeKey(1), out, [&](string& body) { computes++; body += "a"; });
+    CHECK(computes == 2);
+    CHECK(out == "aa");
+    CHECK(none.stats().entries == 0);
+
+    RequestCoalescer kept(milliseconds(50));
+    computes = 0;
+    out = "x";
+    kept.run(makeKey(1), out, [&](string& body) { computes++; body += "a"; });
+    kept.run(makeKey(1), out, [&](string& body) { computes++; body += "b"; });
+    CHECK(computes == 1);
+    CHECK(out == "xaa");
+    CHECK(kept.stats().hits == 1);
+    CHECK(kept.stats().entries == 1);
+
+    this_thread::sleep_for(milliseconds(80));
+    kept.run(makeKey(1), out, [&](string& body) { computes++; body += "c"; });
+    CHECK(computes == 2);
+    CHECK(out == "xaac");
+}
+
+// The leader's exception reaches the request waiting on it, and nothing is kept.
+static void testErrorsReachWaiters() {
+    RequestCoalescer coalescer(milliseconds(1000));
+    atomic<bool> started(false);
+    bool leader_threw = false, follower_threw = false;
+    string first, second;
+
+    thread leader([&]() {
+        try {
+            coalescer.run(makeKey(7), first, [&](string&) {
+                started = true;
+                waitFor([&]() { return coalescer.stats().coalesced == 1; });
+                throw runtime_error("failed");
+            });
+        } catch(const runtime_error&) {
+            leader_threw = true;
+        }
+    });
+    CHECK(waitFor([&]() { return started.load(); }));
+    thread follower([&]() {
+        try {
+            coalescer.run(makeKey(7), second, [&](string& body) { body += "other"; });
+        } catch(const runtime_error&) {
+            follower_threw = true;
+        }
+    });
+    leader.join();
+    follower.join();
+
+    CHECK(leader_threw);
+    CHECK(follower_threw);
+    CHECK(coalescer.stats().entries == 0);
+
+    int computes = 0;
+    coalescer.run(makeKey(7), first, [&](string& body) { computes++; body += "ok"; });
+    CHECK(computes == 1);
+    CHECK(first == "ok");
+}
+
+static void testInvalidKeysAlwaysCompute() {
+    RequestKey key;
+    key.add(string(100, 'k'));
+    CHECK(!key.valid());
+
+    RequestCoalescer coalescer(milliseconds(1000));
+    int computes = 0;
+    string out;
+    for(int i = 0; i < 2; i++) coalescer.run(key, out, [&](string& body) { computes++; body += "a"; });
+    CHECK(computes == 2);
+    CHECK(coalescer.stats().entries == 0);
+}
+
+int main() {
+    testConcurrentRequestsComputeOnce();
+    testTtl();
+    testErrorsReachWaiters();
+    testInvalidKeysAlwaysCompute();
+    return testResult("request_coalescer_test");
+}
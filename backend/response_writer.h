@@ -0,0 +1,208 @@
+#ifndef RESPONSE_WRITER_H
+#define RESPONSE_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <type_traits>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+
+// Streams JSON straight into a caller-owned buffer. Commas and nesting are
+// tracked by the writer, numbers are formatted with std::to_chars, so once the
+// buffer has grown to the size of a typical response no call allocates.
+class JsonWriter {
+public:
+    static constexpr int MAX_DEPTH = 32;
+
+    explicit JsonWriter(std::string& out) : out(out) {}
+
+    JsonWriter& beginObject() { separator(); out += '{'; push(); return *this; }
+    JsonWriter& endObject() { depth--; out += '}'; return *this; }
+    JsonWriter& beginArray() { separator(); out += '['; push(); return *this; }
+    JsonWriter& endArray() { depth--; out += ']'; return *this; }
+
+    JsonWriter& key(std::string_view name) {
+        separator();
+        writeString(name);
+        out += ':';
+        after_key = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view s) { separator(); writeString(s); return *this; }
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    JsonWriter& value(bool b) { separator(); out += b ? "true" : "false"; return *this; }
+
+    template<typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    JsonWriter& value(T v) {
+        separator();
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        out.append(buf, res.ptr);
+        return *this;
+    }
+
+    // Fixed notation with `precision` decimals; NaN and infinities become null.
+    JsonWriter& value(double v, int precision = 6) {
+        separator();
+        if(!std::isfinite(v)) {
+            out += "null";
+            return *this;
+        }
+        char buf[64];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed, precision);
+        if(res.ec != std::errc()) {
+            res = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::scientific, precision);
+        }
+        out.append(buf, res.ptr);
+        return *this;
+    }
+
+    // Inserts an already serialised JSON value as is.
+    JsonWriter& raw(std::string_view json) { separator(); out += json; return *this; }
+
+    template<typename T>
+    JsonWriter& field(std::string_view name, const T& v) { key(name); return value(v); }
+
+private:
+    void push() {
+        depth++;
+        if(depth < MAX_DEPTH) first[depth] = true;
+    }
+
+    void separator() {
+        if(after_key) {
+            after_key = false;
+            return;
+        }
+        if(depth <= 0 || depth >= MAX_DEPTH) return;
+        if(!first[depth]) out += ',';
+        first[depth] = false;
+    }
+
+    void writeString(std::string_view s) {
+        static const char hex[] = "0123456789abcdef";
+        out += '"';
+        size_t run = 0;   // start of the current stretch that needs no escaping
+        for(size_t i = 0; i < s.size(); i++) {
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            if(c >= 0x20 && c != '"' && c != '\\') continue;
+            out.append(s.data() + run, i - run);
+            run = i + 1;
+            switch(c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default: {
+                    char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                    out.append(esc, sizeof(esc));
+                }
+            }
+        }
+        out.append(s.data() + run, s.size() - run);
+        out += '"';
+    }
+
+    std::string& out;
+    int depth = 0;
+    bool after_key = false;
+    bool first[MAX_DEPTH] = {};
+};
+
+// One HTTP response held as two buffers so the head and body can be sent with a
+// single writev without being copied together. Connections keep theirs between
+// requests; reset() keeps the capacity, so steady-state responses do not allocate.
+struct ResponseBuffer {
+    std::string head;
+    std::string body;
+    const char* status = "200 OK";
+    const char* content_type = "application/json";   // nullptr for bodiless replies
+    const char* extra_headers = "";                  // complete "Name: value\r\n" lines
+    bool chunked = false;                            // body follows as appendChunk() pieces
+
+    void reset() {
+        head.clear();
+        body.clear();
+        status = "200 OK";
+        content_type = "application/json";
+        extra_headers = "";
+        chunked = false;
+    }
+
+    // Frames one piece of a chunked body; an empty piece ends the body.
+    void appendChunk(std::string_view data) {
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), data.size(), 16);
+        body.append(buf, res.ptr);
+        body += "\r\n";
+        body += data;
+        body += "\r\n";
+    }
+
+    // Formats the status line and headers for the current body.
+    void writeHead(const char* connection_header) {
+        head.clear();
+        head += "HTTP/1.1 ";
+        head += status;
+        head += "\r\n";
+        if(content_type) {
+            head += "Content-Type: ";
+            head += content_type;
+            head += "\r\n";
+        }
+        head += "Access-Control-Allow-Origin: *\r\n";
+        head += extra_headers;
+        head += connection_header;
+        if(chunked) {
+            head += "Transfer-Encoding: chunked\r\n\r\n";
+            return;
+        }
+        head += "Content-Length: ";
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), body.size());
+        head.append(buf, res.ptr);
+        head += "\r\n\r\n";
+    }
+};
+
+// {"error": message} with the given status.
+inline void writeErrorResponse(ResponseBuffer& out, const char* status, std::string_view message) {
+    out.status = status;
+    out.body.clear();
+    JsonWriter(out.body).beginObject().field("error", message).endObject();
+}
+
+// For a request the worker pool has no room for.
+inline void writeBusyResponse(ResponseBuffer& out) {
+    writeErrorResponse(out, "503 Service Unavailable", "Server busy, retry later");
+    out.extra_headers = "Retry-After: 1\r\n";
+}
+
+// Drops whatever a failed handler had written.
+inline void writeInternalErrorResponse(ResponseBuffer& out) {
+    out.reset();
+    writeErrorResponse(out, "500 Internal Server Error", "Internal server error");
+}
+
+// Runs handle(out). If it throws, out becomes a 500 and the reason goes to
+// error, so a request handed to the worker pool is always answered.
+template<typename Handle>
+bool answerOrFail(ResponseBuffer& out, std::string& error, Handle&& handle) {
+    try {
+        handle(out);
+        return true;
+    } catch(const std::exception& e) {
+        error = e.what();
+    } catch(...) {
+        error = "unknown exception";
+    }
+    writeInternalErrorResponse(out);
+    return false;
+}
+
+#endif
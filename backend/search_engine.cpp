@@ -1,85 +1,574 @@
 #include "search_engine.h"
+#include "simd_kernels.h"
+#include "benchmark.h"
+#include "logger.h"
+#include "counter_rng.h"
+#include "linear_search.h"
+#include "thread_pool.h"
 #include <random>
 #include <algorithm>
-#include <iostream>
 #include <fstream>
-#include <iomanip>
+#include <stdexcept>
+#include <climits>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <string_view>
+#include <cstring>
+#include <charconv>
 
 using namespace std;
 using namespace chrono;
 
+// Runs fill(begin, end) over one contiguous range of [0, n) per thread that
+// parallelism() allows, on the shared helper pool (parallelFor), so a dataset built inside
+// a server worker adds no threads of its own. The generators below compute
+// every element from its index alone, so the result does not depend on how
+// the range is split.
+template<typename Fill>
+static void parallelFill(size_t n, Fill fill) {
+    const size_t min_elements_per_part = 65536;
+    size_t parts = min<size_t>(static_cast<size_t>(parallelism()),
+                               max<size_t>(1, n / min_elements_per_part));
+    size_t chunk = (n + parts - 1) / parts;
+
+    parallelFor(parts, [&](size_t p) { fill(min(n, p * chunk), min(n, (p + 1) * chunk)); });
+}
+
 vector<string> LinearSearchEngine::generateVideoData(int n) {
-    vector<string> videos(n);
-    
-    for(int i = 0; i < n; i++) {
-        videos[i] = "VID_" + to_string(1000000 + i) + "_YouTube";
-    }
-    
     random_device rd;
-    mt19937 g(rd());
-    shuffle(videos.begin(), videos.end(), g);
-    
+    return generateVideoData(n, rd());
+}
+
+// Slot i holds ID 1000000 + permute(i): a shuffle that is a pure function of
+// (seed, i), so it is filled in parallel and is the same for any thread count.
+vector<string> LinearSearchEngine::generateVideoData(int n, uint32_t seed) {
+    vector<string> videos(max(0, n));
+    RandomPermutation permutation(videos.size(), seed);
+
+    parallelFill(videos.size(), [&](size_t begin, size_t end) {
+        char buf[32] = "VID_";
+        for(size_t i = begin; i < end; i++) {
+            auto res = to_chars(buf + 4, buf + sizeof(buf), 1000000 + permutation.permute(i));
+            memcpy(res.ptr, "_YouTube", 8);
+            videos[i].assign(buf, res.ptr + 8 - buf);
+        }
+    });
+
     return videos;
 }
 
-SearchResult LinearSearchEngine::linearSearchIterative(const vector<string>& data, 
+bool VideoKeyCatalog::parseVideoId(const string& id, uint32_t& key) {
+    static const string prefix = "VID_";
+    static const string suffix = "_YouTube";
+
+    if(id.size() <= prefix.size() + suffix.size()) return false;
+    if(id.compare(0, prefix.size(), prefix) != 0) return false;
+    if(id.compare(id.size() - suffix.size(), suffix.size(), suffix) != 0) return false;
+
+    // "VID_01000000_YouTube" is not the ID of key 1000000.
+    size_t digits = id.size() - prefix.size() - suffix.size();
+    if(digits > 1 && id[prefix.size()] == '0') return false;
+
+    uint64_t value = 0;
+    for(size_t i = prefix.size(); i < id.size() - suffix.size(); i++) {
+        if(id[i] < '0' || id[i] > '9') return false;
+        value = value * 10 + (id[i] - '0');
+        if(value > UINT32_MAX) return false;
+    }
+
+    key = static_cast<uint32_t>(value);
+    return true;
+}
+
+string VideoKeyCatalog::formatVideoId(uint32_t key) {
+    return "VID_" + to_string(key) + "_YouTube";
+}
+
+VideoKeyCatalog VideoKeyCatalog::fromStrings(const vector<string>& ids) {
+    VideoKeyCatalog catalog;
+    catalog.keys.resize(ids.size());
+
+    for(size_t i = 0; i < ids.size(); i++) {
+        if(!parseVideoId(ids[i], catalog.keys[i])) {
+            throw invalid_argument("Not a video ID: " + ids[i]);
+        }
+    }
+    return catalog;
+}
+
+VideoKeyCatalog LinearSearchEngine::generateVideoKeys(int n) {
+    random_device rd;
+    return generateVideoKeys(n, rd());
+}
+
+VideoKeyCatalog LinearSearchEngine::generateVideoKeys(int n, uint32_t seed) {
+    VideoKeyCatalog catalog;
+    catalog.keys.resize(max(0, n));
+    RandomPermutation permutation(catalog.keys.size(), seed);
+
+    parallelFill(catalog.keys.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            catalog.keys[i] = static_cast<uint32_t>(1000000 + permutation.permute(i));
+        }
+    });
+
+    return catalog;
+}
+
+vector<string> LinearSearchEngine::generateVideoTitles(int n, uint32_t seed) {
+    static const char* const words[] = {
+        "Lofi", "Beats", "for", "Coding", "Live", "Official", "Music", "Video", "Full", "Album",
+        "How", "to", "Build", "a", "Search", "Engine", "in", "C++", "Explained", "Tutorial",
+        "Minecraft", "Speedrun", "World", "Record", "Reaction", "Trailer", "Review", "Unboxing",
+        "The", "Ultimate", "Guide", "Cooking", "Pasta", "at", "Home", "Travel", "Vlog", "Tokyo",
+        "Night", "Walk", "Rain", "Sounds", "Sleep", "Study", "Session", "Highlights", "Interview",
+        "Podcast", "Episode", "Behind", "Scenes", "Documentary", "Short", "Film", "Remix", "Cover"
+    };
+    const uint64_t word_count = sizeof(words) / sizeof(words[0]);
+
+    // The episode number keeps titles unique, so a search has exactly one hit.
+    // Each episode draws its words from its own SplitMix stream.
+    vector<string> titles(max(0, n));
+    RandomPermutation permutation(titles.size(), seed);
+    SplitMix64 streams(SplitMix64::mix(seed));
+
+    parallelFill(titles.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            uint64_t episode = permutation.permute(i);
+            SplitMix64 rng(streams.at(episode));
+            string& title = titles[i];
+            int count = 2 + static_cast<int>(rng.next() % 8);
+            for(int w = 0; w < count; w++) {
+                if(w > 0) title += ' ';
+                title += words[rng.next() % word_count];
+            }
+            title += " - Ep. ";
+            title += to_string(episode + 1);
+        }
+    });
+
+    return titles;
+}
+
+uint32_t FlatStringTable::fingerprint(string_view s) {
+    uint64_t h = hash<string_view>{}(s);
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+FlatStringTable FlatStringTable::fromStrings(const vector<string>& strings) {
+    FlatStringTable table;
+    size_t total = 0;
+    for(const auto& s : strings) total += s.size();
+    table.arena.reserve(total);
+    table.offsets.reserve(strings.size() + 1);
+    table.fingerprints.reserve(strings.size());
+    for(const auto& s : strings) table.push_back(s);
+    return table;
+}
+
+void FlatStringTable::push_back(string_view s) {
+    arena.append(s.data(), s.size());
+    offsets.push_back(arena.size());
+    fingerprints.push_back(fingerprint(s));
+}
+
+size_t LinearSearchEngine::stringCatalogBytes(const vector<string>& data) {
+    // The vector's slots plus one heap block per string that outgrew the
+    // small-string buffer (which lives inside sizeof(string)).
+    size_t bytes = data.capacity() * sizeof(string);
+    for(const auto& s : data) {
+        if(s.capacity() > string().capacity()) bytes += s.capacity() + 1;
+    }
+    return bytes;
+}
+
+// Wraps a search measured by the templated engine in a SearchResult.
+template<typename Key, typename Equal>
+static SearchResult measuredResult(const char* algorithm, const string& target, size_t n,
+                                   size_t index, const LinearSearch<Key, Equal, MeasureSearch>& search) {
+    const MeasureSearch& m = search.instrumentation();
+    SearchResult result;
+    result.algorithm = algorithm;
+    result.target = target;
+    result.data_size = static_cast<int>(n);
+    result.found = (index != LinearSearch<Key, Equal, MeasureSearch>::npos);
+    result.index = result.found ? static_cast<int>(index) : -1;
+    result.comparisons = static_cast<int>(m.comparisons);
+    result.execution_time_ns = m.elapsed_ns;
+    result.counters = m.counters;
+    return result;
+}
+
+SearchResult LinearSearchEngine::linearSearchIterative(const vector<string>& data,
+                                                     const string& target) {
+    LinearSearch<string, equal_to<string>, MeasureSearch> search;
+    size_t index = search.iterative(data, target);
+    return measuredResult("iterative", target, data.size(), index, search);
+}
+
+SearchResult LinearSearchEngine::linearSearchIterative(const StringTableView& data,
+                                                     const string& target) {
+    LinearSearch<string_view, equal_to<string_view>, MeasureSearch> search;
+    size_t index = search.iterative(data, string_view(target));
+    return measuredResult("iterative_table", target, data.size(), index, search);
+}
+
+SearchResult LinearSearchEngine::linearSearchIterative(const FlatStringTable& data,
                                                      const string& target) {
     SearchResult result;
-    result.algorithm = "iterative";
+    result.algorithm = "flat";
     result.target = target;
     result.data_size = static_cast<int>(data.size());
-    result.comparisons = 0;
-    
+
+    PerfScope perf;
     auto start = high_resolution_clock::now();
-    
-    for(size_t i = 0; i < data.size(); i++) {
-        result.comparisons++;
-        if(data[i] == target) {
-            result.index = static_cast<int>(i);
-            result.found = true;
-            
-            auto end = high_resolution_clock::now();
-            result.execution_time_ns = duration_cast<nanoseconds>(end - start).count();
-            
-            return result;
-        }
+
+    // Fingerprints are a plain uint32_t array, so the SIMD key kernel finds
+    // candidates; the length check and the byte compare only rule out the
+    // occasional collision.
+    uint32_t wanted = FlatStringTable::fingerprint(target);
+    const uint32_t* fingerprints = data.fingerprints.data();
+    size_t n = data.size();
+    size_t i = findKey(fingerprints, n, wanted);
+    while(i < n && (data.length(i) != target.size() ||
+                    memcmp(data.arena.data() + data.offsets[i], target.data(), target.size()) != 0)) {
+        i++;
+        i += findKey(fingerprints + i, n - i, wanted);
     }
-    
+
+    auto end = high_resolution_clock::now();
+    result.counters = perf.stop();
+    result.execution_time_ns = duration_cast<nanoseconds>(end - start).count();
+
+    result.found = (i < n);
+    result.index = result.found ? static_cast<int>(i) : -1;
+    result.comparisons = static_cast<int>(result.found ? i + 1 : n);
+
+    return result;
+}
+
+SearchResult LinearSearchEngine::linearSearchIterative(VideoKeyView data, uint32_t target_key) {
+    LinearSearch<uint32_t, equal_to<uint32_t>, MeasureSearch> search;
+    size_t index = search.iterative(data, target_key);
+    return measuredResult("iterative_compact", VideoKeyCatalog::formatVideoId(target_key),
+                          data.size(), index, search);
+}
+
+SearchResult LinearSearchEngine::linearSearchIterative(VideoKeyView data, const string& target) {
+    uint32_t key;
+    if(VideoKeyCatalog::parseVideoId(target, key)) {
+        SearchResult result = linearSearchIterative(data, key);
+        result.target = target;
+        return result;
+    }
+
+    // Not a video ID, so no element can match; a scan would have compared them all.
+    SearchResult result;
+    result.algorithm = "iterative_compact";
+    result.target = target;
+    result.data_size = static_cast<int>(data.size());
+    result.comparisons = result.data_size;
     result.index = -1;
     result.found = false;
+    result.execution_time_ns = 0;
+    return result;
+}
+
+SearchResult LinearSearchEngine::linearSearchSimd(VideoKeyView data, uint32_t target_key) {
+    SearchResult result;
+    result.algorithm = "simd";
+    result.target = VideoKeyCatalog::formatVideoId(target_key);
+    result.data_size = static_cast<int>(data.size());
+
+    PerfScope perf;
+    auto start = high_resolution_clock::now();
+    size_t n = data.size();
+    size_t i = findKey(data.keys, n, target_key);
     auto end = high_resolution_clock::now();
+    result.counters = perf.stop();
     result.execution_time_ns = duration_cast<nanoseconds>(end - start).count();
-    
+
+    // The kernel compares whole vectors at once, but only the keys up to the
+    // first match count as comparisons, exactly as in the scalar scan.
+    result.found = (i < n);
+    result.index = result.found ? static_cast<int>(i) : -1;
+    result.comparisons = static_cast<int>(result.found ? i + 1 : n);
+
     return result;
 }
 
-SearchResult LinearSearchEngine::linearSearchRecursive(const vector<string>& data, 
-                                                     const string& target) {
+SearchResult LinearSearchEngine::linearSearchSimd(VideoKeyView data, const string& target) {
+    uint32_t key;
+    if(VideoKeyCatalog::parseVideoId(target, key)) {
+        SearchResult result = linearSearchSimd(data, key);
+        result.target = target;
+        return result;
+    }
+
+    SearchResult result = linearSearchIterative(data, target);
+    result.algorithm = "simd";
+    return result;
+}
+
+SearchResult LinearSearchEngine::linearSearchParallel(const vector<string>& data,
+                                                    const string& target, int threads) {
+    const size_t cache_line = 64;
+    const size_t min_elements_per_thread = 16384;
+    const size_t chunk_lines = 256;
+
     SearchResult result;
-    result.algorithm = "recursive";
+    result.algorithm = "parallel";
     result.target = target;
     result.data_size = static_cast<int>(data.size());
-    result.comparisons = 0;
-    
+
+    size_t n = data.size();
+    if(threads <= 0) threads = parallelism();
+    threads = static_cast<int>(min<size_t>(threads, max<size_t>(1, n / min_elements_per_thread)));
+
+    // Chunk boundaries fall on cache lines of the element array, so no two
+    // workers ever read the same line.
+    size_t per_line = max<size_t>(1, cache_line / sizeof(string));
+    size_t chunk = per_line * chunk_lines;
+    size_t misalign = reinterpret_cast<uintptr_t>(data.data()) % cache_line;
+    size_t head = (misalign % sizeof(string) == 0)
+                ? ((cache_line - misalign) % cache_line) / sizeof(string) : 0;
+    size_t chunk_count = (n + chunk - 1) / chunk;
+
+    // Chunks are claimed in increasing order. best holds the lowest match so
+    // far; a worker stops as soon as it is past it, because nothing it could
+    // still find would be the first occurrence.
+    atomic<size_t> next_chunk(0);
+    atomic<size_t> best(n);
+    result.thread_comparisons.assign(threads, 0);
+
+    // Counters follow the calling thread only.
+    PerfScope perf;
     auto start = high_resolution_clock::now();
-    
-    function<int(const vector<string>&, const string&, int, int&)> recursiveSearch;
-    recursiveSearch = [&recursiveSearch](const vector<string>& arr, const string& tgt, 
-                                        int idx, int& comps) -> int {
-        if(idx >= static_cast<int>(arr.size())) return -1;
-        
-        comps++;
-        if(arr[idx] == tgt) return idx;
-        
-        return recursiveSearch(arr, tgt, idx + 1, comps);
+
+    // Each chunk is scanned in blocks of 64 elements, checking best in between.
+    const size_t block = 64;
+    auto worker = [&](int id) {
+        LinearSearch<string, equal_to<string>, CountComparisons> scan;
+        long long comparisons = 0;
+        while(true) {
+            size_t c = next_chunk.fetch_add(1, memory_order_relaxed);
+            if(c >= chunk_count) break;
+
+            size_t begin = (c == 0) ? 0 : min(n, head + c * chunk);
+            size_t end = min(n, head + (c + 1) * chunk);
+            if(begin >= best.load(memory_order_relaxed)) break;
+
+            for(size_t b = begin; b < end && b < best.load(memory_order_relaxed); b += block) {
+                size_t hit = scan.iterative(SequenceSlice<vector<string>>{data, b, min(block, end - b)}, target);
+                comparisons += scan.instrumentation().comparisons;
+                if(hit != scan.npos) {
+                    size_t i = b + hit;
+                    size_t current = best.load(memory_order_relaxed);
+                    while(i < current && !best.compare_exchange_weak(current, i)) {}
+                    break;
+                }
+            }
+        }
+        result.thread_comparisons[id] = static_cast<int>(comparisons);
     };
-    
-    result.index = recursiveSearch(data, target, 0, result.comparisons);
-    result.found = (result.index != -1);
-    
+
+    // Workers run on the shared helper pool and the calling thread, so
+    // concurrent requests do not each start threads of their own.
+    parallelFor(static_cast<size_t>(threads), [&](size_t id) { worker(static_cast<int>(id)); });
+
     auto end = high_resolution_clock::now();
+    result.counters = perf.stop();
     result.execution_time_ns = duration_cast<nanoseconds>(end - start).count();
-    
+
+    size_t index = best.load();
+    result.found = (index < n);
+    result.index = result.found ? static_cast<int>(index) : -1;
+    result.comparisons = 0;
+    for(int c : result.thread_comparisons) result.comparisons += c;
+
+    return result;
+}
+
+int LinearSearchEngine::maxRecursiveSize() {
+#ifdef LINEAR_SEARCH_MUSTTAIL
+    return INT_MAX;
+#else
+    // Tail-call elimination is not guaranteed, even when optimising, so every
+    // element may cost a stack frame.
+    return 10000;
+#endif
+}
+
+SearchResult LinearSearchEngine::linearSearchRecursive(const vector<string>& data,
+                                                     const string& target) {
+    LinearSearch<string, equal_to<string>, MeasureSearch> search;
+    size_t index = search.recursive(data, target);
+    return measuredResult("recursive", target, data.size(), index, search);
+}
+
+SearchResult LinearSearchEngine::linearSearchDivideConquer(const vector<string>& data,
+                                                         const string& target) {
+    LinearSearch<string, equal_to<string>, MeasureSearch> search;
+    size_t index = search.divideConquer(data, target);
+    return measuredResult("divide", target, data.size(), index, search);
+}
+
+// Open-addressing set of the targets for linearSearchMulti. Each slot holds a
+// distinct target; duplicates in the request are chained behind the first
+// copy through next_same so they are all answered by the same hit. A bitmap
+// 32 times larger than the table, indexed by the same hash, rejects almost
+// every non-target with one well-predicted branch before the table is probed.
+template<typename Key, typename Hash>
+struct TargetSet {
+    vector<Key> slot_key;
+    vector<int> slot_target;    // first target with this key, -1 for an empty slot
+    vector<int> next_same;
+    vector<uint64_t> filter;
+    size_t mask;
+    size_t filter_mask;
+    int distinct = 0;
+    Hash hash;
+
+    explicit TargetSet(const vector<Key>& targets) : next_same(targets.size(), -1) {
+        size_t capacity = 16;
+        while(capacity < targets.size() * 2) capacity <<= 1;   // load factor <= 0.5
+        slot_key.resize(capacity);
+        slot_target.assign(capacity, -1);
+        mask = capacity - 1;
+        filter.assign(capacity * 32 / 64, 0);
+        filter_mask = capacity * 32 - 1;
+
+        vector<int> last_same(targets.size());
+        for(size_t t = 0; t < targets.size(); t++) {
+            size_t h = hash(targets[t]) & mask;
+            while(slot_target[h] >= 0 && !(slot_key[h] == targets[t])) h = (h + 1) & mask;
+            if(slot_target[h] < 0) {
+                size_t bit = hash(targets[t]) & filter_mask;
+                filter[bit >> 6] |= uint64_t(1) << (bit & 63);
+                slot_key[h] = targets[t];
+                slot_target[h] = static_cast<int>(t);
+                last_same[t] = static_cast<int>(t);
+                distinct++;
+            } else {
+                int first = slot_target[h];
+                next_same[last_same[first]] = static_cast<int>(t);
+                last_same[first] = static_cast<int>(t);
+            }
+        }
+    }
+
+    // First target equal to key, or -1.
+    int find(const Key& key) const {
+        size_t full = hash(key);
+        size_t bit = full & filter_mask;
+        if(!(filter[bit >> 6] & (uint64_t(1) << (bit & 63)))) return -1;
+        size_t h = full & mask;
+        while(slot_target[h] >= 0) {
+            if(slot_key[h] == key) return slot_target[h];
+            h = (h + 1) & mask;
+        }
+        return -1;
+    }
+};
+
+struct KeyHash {
+    size_t operator()(uint32_t key) const {
+        return static_cast<size_t>((uint64_t(key) * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+};
+
+// Scans data[0, n) once and fills the hit of every target. hits must already
+// hold one not-found entry per target.
+template<typename Key, typename Hash, typename KeyAt>
+static void multiScan(size_t n, KeyAt key_at, const vector<Key>& targets,
+                      vector<TargetHit>& hits, long long& elements_scanned) {
+    TargetSet<Key, Hash> set(targets);
+    int remaining = set.distinct;
+
+    size_t i = 0;
+    for(; i < n && remaining > 0; i++) {
+        int t = set.find(key_at(i));
+        if(t < 0 || hits[t].found) continue;
+        remaining--;
+        for(; t >= 0; t = set.next_same[t]) {
+            hits[t].index = static_cast<int>(i);
+            hits[t].comparisons = static_cast<int>(i + 1);
+            hits[t].found = true;
+        }
+    }
+    elements_scanned = static_cast<long long>(i);
+}
+
+static MultiSearchResult startMultiResult(const char* algorithm, size_t n,
+                                          const vector<string>& targets) {
+    MultiSearchResult result;
+    result.algorithm = algorithm;
+    result.data_size = static_cast<int>(n);
+    result.elements_scanned = 0;
+    result.found_count = 0;
+    result.hits.reserve(targets.size());
+    for(const auto& t : targets) {
+        result.hits.push_back(TargetHit{t, -1, static_cast<int>(n), false});
+    }
+    return result;
+}
+
+static void finishMultiResult(MultiSearchResult& result) {
+    for(const auto& hit : result.hits) result.found_count += hit.found;
+}
+
+MultiSearchResult LinearSearchEngine::linearSearchMulti(const vector<string>& data,
+                                                      const vector<string>& targets) {
+    MultiSearchResult result = startMultiResult("multi", data.size(), targets);
+    vector<string_view> wanted(targets.begin(), targets.end());
+
+    PerfScope perf;
+    auto start = high_resolution_clock::now();
+    multiScan<string_view, hash<string_view>>(
+        data.size(), [&](size_t i) { return string_view(data[i]); }, wanted,
+        result.hits, result.elements_scanned);
+    auto end = high_resolution_clock::now();
+    result.counters = perf.stop();
+    result.execution_time_ns = duration_cast<nanoseconds>(end - start).count();
+
+    finishMultiResult(result);
+    return result;
+}
+
+MultiSearchResult LinearSearchEngine::linearSearchMulti(VideoKeyView data,
+                                                      const vector<string>& targets) {
+    MultiSearchResult result = startMultiResult("multi_compact", data.size(), targets);
+
+    // Targets that are not video IDs cannot match a key and keep their not-found hit.
+    vector<uint32_t> keys;
+    vector<int> target_of_key;
+    for(size_t t = 0; t < targets.size(); t++) {
+        uint32_t key;
+        if(VideoKeyCatalog::parseVideoId(targets[t], key)) {
+            keys.push_back(key);
+            target_of_key.push_back(static_cast<int>(t));
+        }
+    }
+    vector<TargetHit> key_hits(keys.size(), TargetHit{string(), -1, static_cast<int>(data.size()), false});
+
+    PerfScope perf;
+    auto start = high_resolution_clock::now();
+    multiScan<uint32_t, KeyHash>(
+        data.size(), [&](size_t i) { return data[i]; }, keys,
+        key_hits, result.elements_scanned);
+    auto end = high_resolution_clock::now();
+    result.counters = perf.stop();
+    result.execution_time_ns = duration_cast<nanoseconds>(end - start).count();
+
+    for(size_t k = 0; k < keys.size(); k++) {
+        TargetHit& hit = result.hits[target_of_key[k]];
+        hit.index = key_hits[k].index;
+        hit.comparisons = key_hits[k].comparisons;
+        hit.found = key_hits[k].found;
+    }
+    finishMultiResult(result);
     return result;
 }
 
@@ -96,11 +585,23 @@ SearchResult LinearSearchEngine::runBenchmark(int data_size, const string& algor
     
     string target = videos[data_size / 2];
     
-    if(algorithm == "iterative") {
+    if(algorithm == "simd") {
+        return linearSearchSimd(VideoKeyCatalog::fromStrings(videos), target);
+    }
+    else if(algorithm == "parallel") {
+        // Warm the caches first so neither timing pays for the first touch.
+        LinearSearch<string>().iterative(videos, target);
+        auto baseline = linearSearchIterative(videos, target);
+        auto result = linearSearchParallel(videos, target);
+        result.speedup = static_cast<double>(baseline.execution_time_ns) /
+                         max(1LL, result.execution_time_ns);
+        return result;
+    }
+    else if(algorithm == "iterative") {
         return linearSearchIterative(videos, target);
     } 
     else if(algorithm == "recursive") {
-        if(data_size > 10000) {
+        if(data_size > maxRecursiveSize()) {
             SearchResult result;
             result.algorithm = "recursive";
             result.data_size = data_size;
@@ -112,54 +613,193 @@ SearchResult LinearSearchEngine::runBenchmark(int data_size, const string& algor
         }
         return linearSearchRecursive(videos, target);
     }
+    else if(algorithm == "divide") {
+        return linearSearchDivideConquer(videos, target);
+    }
     else {
         return linearSearchIterative(videos, target);
     }
 }
 
-vector<BenchmarkData> LinearSearchEngine::runPerformanceAnalysis() {
+vector<BenchmarkData> LinearSearchEngine::runPerformanceAnalysis(const BenchmarkConfig& config) {
     vector<BenchmarkData> results;
+    vector<BenchmarkStats> all_stats;
     vector<int> sizes = {1, 10, 20, 30, 40, 50, 60, 70, 80, 90, 
                          100, 200, 300, 400, 500, 600, 700, 800, 900,
-                         1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000};
+                         1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000,
+                         100000, 1000000};
     
-    cout << "Running performance analysis for " << sizes.size() << " different sizes..." << endl;
+    BenchmarkHarness harness(config);
+    
+    Logger::info("Running performance analysis for %zu different sizes...", sizes.size());
+    Logger::info("SIMD kernel: %s", simdLevelName(detectSimdLevel()));
+    Logger::info("Perf counters: %s", PerfCounters::status().c_str());
+    Logger::info("Warmup: %d | Repetitions: %d | Target: %s | Cache flush: %s | Times are medians",
+                 config.warmup, config.repetitions, BenchmarkHarness::positionName(config.position),
+                 config.flush_cache ? "on" : "off");
     
     for(int size : sizes) {
-        BenchmarkData data;
-        data.size = size;
+        auto videos = generateVideoData(size, config.seed);
+        auto keys = generateVideoKeys(size, config.seed);
         
-        auto iter_result = runBenchmark(size, "iterative");
-        auto rec_result = runBenchmark(size, "recursive");
+        auto iter_stats = harness.run("iterative", videos, keys);
+        auto rec_stats = harness.run("recursive", videos, keys);
+        auto simd_stats = harness.run("simd", videos, keys);
+        auto divide_stats = harness.run("divide", videos, keys);
         
-        data.iterative_time_ns = iter_result.execution_time_ns;
-        data.recursive_time_ns = rec_result.execution_time_ns;
-        data.iterative_comparisons = iter_result.comparisons;
-        data.recursive_comparisons = rec_result.comparisons;
+        BenchmarkData data;
+        data.size = size;
+        data.iterative_time_ns = llround(iter_stats.median_ns);
+        data.recursive_time_ns = llround(rec_stats.median_ns);
+        data.simd_time_ns = llround(simd_stats.median_ns);
+        data.divide_time_ns = llround(divide_stats.median_ns);
+        data.iterative_comparisons = static_cast<int>(lround(iter_stats.mean_comparisons));
+        data.recursive_comparisons = static_cast<int>(lround(rec_stats.mean_comparisons));
+        data.simd_comparisons = static_cast<int>(lround(simd_stats.mean_comparisons));
+        data.divide_comparisons = static_cast<int>(lround(divide_stats.mean_comparisons));
         
         results.push_back(data);
+        all_stats.push_back(iter_stats);
+        all_stats.push_back(rec_stats);
+        all_stats.push_back(simd_stats);
+        all_stats.push_back(divide_stats);
         
-        cout << "Size: " << setw(5) << size 
-             << " | Iterative: " << setw(8) << iter_result.execution_time_ns << " ns"
-             << " | Recursive: " << setw(8) << rec_result.execution_time_ns << " ns"
-             << " | Iter Comps: " << setw(5) << iter_result.comparisons
-             << " | Rec Comps: " << setw(5) << rec_result.comparisons
-             << endl;
+        double iter_ns = max(1.0, iter_stats.median_ns);
+        Logger::info("Size: %7d | Iterative: %9lld ns (p95 %9lld) | Recursive: %9lld ns (%.2fx)"
+                     " | Divide: %9lld ns (%.2fx) | SIMD: %8lld ns | Iter Comps: %5d | Rec Comps: %5d"
+                     " | SIMD Comps: %5d | Div Comps: %5d",
+                     size, data.iterative_time_ns, llround(iter_stats.p95_ns), data.recursive_time_ns,
+                     rec_stats.median_ns / iter_ns, data.divide_time_ns, divide_stats.median_ns / iter_ns,
+                     data.simd_time_ns, data.iterative_comparisons, data.recursive_comparisons,
+                     data.simd_comparisons, data.divide_comparisons);
     }
     
     ofstream csv_file("performance_results.csv");
-    csv_file << "Size,Iterative_Time_ns,Recursive_Time_ns,Iterative_Comparisons,Recursive_Comparisons" << endl;
+    csv_file << "Size,Iterative_Time_ns,Recursive_Time_ns,Iterative_Comparisons,Recursive_Comparisons,"
+                "SIMD_Time_ns,SIMD_Comparisons,Divide_Time_ns,Divide_Comparisons\n";
     
     for(const auto& data : results) {
         csv_file << data.size << ","
                 << data.iterative_time_ns << ","
                 << data.recursive_time_ns << ","
                 << data.iterative_comparisons << ","
-                << data.recursive_comparisons << endl;
+                << data.recursive_comparisons << ","
+                << data.simd_time_ns << ","
+                << data.simd_comparisons << ","
+                << data.divide_time_ns << ","
+                << data.divide_comparisons << '\n';
     }
     
     csv_file.close();
-    cout << "\nResults saved to performance_results.csv" << endl;
+    
+    BenchmarkHarness::writeCsv("benchmark_results.csv", all_stats);
+    BenchmarkHarness::writeJson("benchmark_results.json", all_stats, config);
+    
+    Logger::info("Results saved to performance_results.csv (medians), "
+                 "benchmark_results.csv and benchmark_results.json (full statistics)");
     
     return results;
-}
\ No newline at end of file
+}
+
+vector<LayoutBenchmarkData> LinearSearchEngine::runLayoutAnalysis(const BenchmarkConfig& config) {
+    vector<LayoutBenchmarkData> results;
+    vector<int> sizes = {100000, 1000000, 10000000};
+    vector<int> title_sizes = {100000, 1000000};
+    const int repetitions = 5;
+
+    Logger::info("Comparing vector<string> with compact key catalog and flat string table...");
+
+    for(int size : sizes) {
+        auto videos = generateVideoData(size, config.seed);
+        auto catalog = generateVideoKeys(size, config.seed);
+        auto flat = FlatStringTable::fromStrings(videos);
+
+        // Last element: every layout scans the whole catalog.
+        string target = videos.back();
+
+        LayoutBenchmarkData data;
+        data.catalog = "ids";
+        data.size = size;
+        data.string_bytes = stringCatalogBytes(videos);
+        data.compact_bytes = catalog.memoryBytes();
+        data.flat_bytes = flat.memoryBytes();
+        data.string_time_ns = LLONG_MAX;
+        data.compact_time_ns = LLONG_MAX;
+        data.flat_time_ns = LLONG_MAX;
+
+        for(int r = 0; r < repetitions; r++) {
+            auto str_result = linearSearchIterative(videos, target);
+            auto key_result = linearSearchIterative(catalog, target);
+            auto flat_result = linearSearchIterative(flat, target);
+            data.string_time_ns = min(data.string_time_ns, str_result.execution_time_ns);
+            data.compact_time_ns = min(data.compact_time_ns, key_result.execution_time_ns);
+            data.flat_time_ns = min(data.flat_time_ns, flat_result.execution_time_ns);
+        }
+
+        data.string_elements_per_sec = size * 1e9 / max(1LL, data.string_time_ns);
+        data.compact_elements_per_sec = size * 1e9 / max(1LL, data.compact_time_ns);
+        data.flat_elements_per_sec = size * 1e9 / max(1LL, data.flat_time_ns);
+        results.push_back(data);
+
+        Logger::info("IDs    %8d | String: %10lld ns, %6zu KiB | Compact: %10lld ns, %6zu KiB | "
+                     "Flat: %10lld ns, %6zu KiB",
+                     size, data.string_time_ns, data.string_bytes / 1024, data.compact_time_ns,
+                     data.compact_bytes / 1024, data.flat_time_ns, data.flat_bytes / 1024);
+    }
+
+    // Titles have no numeric key, so only the string layouts apply.
+    for(int size : title_sizes) {
+        auto titles = generateVideoTitles(size, config.seed);
+        auto flat = FlatStringTable::fromStrings(titles);
+        string target = titles.back();
+
+        LayoutBenchmarkData data;
+        data.catalog = "titles";
+        data.size = size;
+        data.string_bytes = stringCatalogBytes(titles);
+        data.compact_bytes = 0;
+        data.flat_bytes = flat.memoryBytes();
+        data.string_time_ns = LLONG_MAX;
+        data.compact_time_ns = 0;
+        data.flat_time_ns = LLONG_MAX;
+
+        for(int r = 0; r < repetitions; r++) {
+            auto str_result = linearSearchIterative(titles, target);
+            auto flat_result = linearSearchIterative(flat, target);
+            data.string_time_ns = min(data.string_time_ns, str_result.execution_time_ns);
+            data.flat_time_ns = min(data.flat_time_ns, flat_result.execution_time_ns);
+        }
+
+        data.string_elements_per_sec = size * 1e9 / max(1LL, data.string_time_ns);
+        data.compact_elements_per_sec = 0;
+        data.flat_elements_per_sec = size * 1e9 / max(1LL, data.flat_time_ns);
+        results.push_back(data);
+
+        Logger::info("Titles %8d | String: %10lld ns, %6zu KiB | Flat: %10lld ns, %6zu KiB | Speedup: %.1fx",
+                     size, data.string_time_ns, data.string_bytes / 1024, data.flat_time_ns,
+                     data.flat_bytes / 1024, data.flat_elements_per_sec / data.string_elements_per_sec);
+    }
+
+    ofstream csv_file("layout_results.csv");
+    csv_file << "Catalog,Size,String_Bytes,Compact_Bytes,Flat_Bytes,String_Time_ns,Compact_Time_ns,"
+                "Flat_Time_ns,String_Elements_per_sec,Compact_Elements_per_sec,Flat_Elements_per_sec\n";
+
+    for(const auto& data : results) {
+        csv_file << data.catalog << ","
+                << data.size << ","
+                << data.string_bytes << ","
+                << data.compact_bytes << ","
+                << data.flat_bytes << ","
+                << data.string_time_ns << ","
+                << data.compact_time_ns << ","
+                << data.flat_time_ns << ","
+                << static_cast<long long>(data.string_elements_per_sec) << ","
+                << static_cast<long long>(data.compact_elements_per_sec) << ","
+                << static_cast<long long>(data.flat_elements_per_sec) << '\n';
+    }
+
+    csv_file.close();
+    Logger::info("Results saved to layout_results.csv");
+
+    return results;
+}
@@ -4,7 +4,9 @@
 #include <vector>
 #include <string>
 #include <chrono>
-#include <functional>
+#include <cstdint>
+#include <string_view>
+#include "perf_counters.h"
 
 struct SearchResult {
     int index;
@@ -14,25 +16,195 @@ struct SearchResult {
     std::string algorithm;
     std::string target;
     int data_size;
+    std::vector<int> thread_comparisons;    // parallel search: comparisons per worker
+    double speedup = 0.0;                   // parallel search: iterative time / parallel time
+    long long build_time_ns = 0;            // prebuilt indexes: time to build the index
+    size_t memory_bytes = 0;                // prebuilt indexes: size of the index
+    PerfCounterValues counters;             // hardware counters, when PerfCounters is enabled
+};
+
+// Outcome for one target of a multi-target search, as a single search would report it.
+struct TargetHit {
+    std::string target;
+    int index;          // -1 when not found
+    int comparisons;    // elements a single scan for this target would have compared
+    bool found;
+};
+
+struct MultiSearchResult {
+    std::string algorithm;
+    int data_size;
+    long long elements_scanned;         // elements the one pass actually read
+    long long execution_time_ns;
+    int found_count;
+    std::vector<TargetHit> hits;        // one per target, in the order given
+    PerfCounterValues counters;
 };
 
 struct BenchmarkData {
     int size;
     long long iterative_time_ns;
     long long recursive_time_ns;
+    long long simd_time_ns;
+    long long divide_time_ns;
     int iterative_comparisons;
     int recursive_comparisons;
+    int simd_comparisons;
+    int divide_comparisons;
+};
+
+enum class TargetPosition {
+    Best,       // first element
+    Average,    // middle element
+    Worst,      // last element
+    Random      // a new random element every repetition
+};
+
+struct BenchmarkConfig {
+    int warmup = 5;
+    int repetitions = 50;
+    bool flush_cache = false;           // sweep a buffer larger than the LLC before every run
+    TargetPosition position = TargetPosition::Average;
+    uint32_t seed = 0;                  // dataset shuffle and random target positions
+};
+
+// Summary of repeated timings of one algorithm at one size.
+struct BenchmarkStats {
+    std::string algorithm;
+    int size;
+    std::string position;
+    int repetitions;                    // 0 when the algorithm cannot run at this size
+    double min_ns;
+    double median_ns;
+    double p95_ns;
+    double p99_ns;
+    double mean_ns;
+    double stddev_ns;
+    double ns_per_element;
+    double mean_comparisons;
+    // Mean hardware counts per search, -1 when the counters were unavailable.
+    double cycles;
+    double instructions;
+    double l1d_misses;
+    double llc_misses;
+    double branch_misses;
+};
+
+struct LayoutBenchmarkData {
+    std::string catalog;                // "ids" or "titles"
+    int size;
+    size_t string_bytes;
+    size_t compact_bytes;               // 0 for titles, which have no numeric key
+    size_t flat_bytes;
+    long long string_time_ns;
+    long long compact_time_ns;
+    long long flat_time_ns;
+    double string_elements_per_sec;
+    double compact_elements_per_sec;
+    double flat_elements_per_sec;
+};
+
+// Non-owning view of contiguous keys: a VideoKeyCatalog or the key section
+// of a memory-mapped catalog file (see catalog_file.h).
+struct VideoKeyView {
+    const uint32_t* keys = nullptr;
+    size_t count = 0;
+
+    size_t size() const { return count; }
+    uint32_t operator[](size_t i) const { return keys[i]; }
+};
+
+// Non-owning view of packed strings: string i is bytes[offsets[i], offsets[i + 1]).
+struct StringTableView {
+    const uint64_t* offsets = nullptr;
+    const char* bytes = nullptr;
+    size_t count = 0;
+
+    size_t size() const { return count; }
+    std::string_view operator[](size_t i) const {
+        return std::string_view(bytes + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+};
+
+// Arbitrary strings (titles, IDs) packed back to back in one arena, with
+// n + 1 offsets and a 32-bit fingerprint per string. A scan compares the
+// contiguous fingerprints first and reads lengths and bytes only for the
+// rare candidates whose fingerprint matches.
+struct FlatStringTable {
+    std::string arena;
+    std::vector<uint64_t> offsets{0};
+    std::vector<uint32_t> fingerprints;
+
+    static uint32_t fingerprint(std::string_view s);
+    static FlatStringTable fromStrings(const std::vector<std::string>& strings);
+
+    void push_back(std::string_view s);
+    size_t size() const { return fingerprints.size(); }
+    size_t length(size_t i) const { return offsets[i + 1] - offsets[i]; }
+    std::string_view operator[](size_t i) const {
+        return std::string_view(arena.data() + offsets[i], length(i));
+    }
+    size_t memoryBytes() const {
+        return arena.capacity() + offsets.capacity() * sizeof(uint64_t) +
+               fingerprints.capacity() * sizeof(uint32_t);
+    }
+    operator StringTableView() const { return StringTableView{offsets.data(), arena.data(), size()}; }
+};
+
+// Catalog of "VID_<n>_YouTube" IDs stored as their numeric part in one
+// contiguous array. The string form is only rebuilt for display.
+struct VideoKeyCatalog {
+    std::vector<uint32_t> keys;
+
+    // Accepts exactly the strings formatVideoId produces: no sign and no
+    // leading zeros, so every key has one string form.
+    static bool parseVideoId(const std::string& id, uint32_t& key);
+    static std::string formatVideoId(uint32_t key);
+    static VideoKeyCatalog fromStrings(const std::vector<std::string>& ids);
+
+    size_t size() const { return keys.size(); }
+    std::string displayAt(size_t i) const { return formatVideoId(keys[i]); }
+    size_t memoryBytes() const { return keys.capacity() * sizeof(uint32_t); }
+    operator VideoKeyView() const { return VideoKeyView{keys.data(), keys.size()}; }
 };
 
 class LinearSearchEngine {
 public:
     static std::vector<std::string> generateVideoData(int n);
+    static std::vector<std::string> generateVideoData(int n, uint32_t seed);
+    static VideoKeyCatalog generateVideoKeys(int n);
+    // Same catalog and order as generateVideoData(n, seed), without building the strings.
+    static VideoKeyCatalog generateVideoKeys(int n, uint32_t seed);
+    // Unique variable-length titles ("Lofi Beats for Coding ... - Ep. 42"), shuffled with seed.
+    static std::vector<std::string> generateVideoTitles(int n, uint32_t seed);
     static SearchResult linearSearchIterative(const std::vector<std::string>& data, 
                                              const std::string& target);
+    static SearchResult linearSearchIterative(const StringTableView& data,
+                                             const std::string& target);
+    static SearchResult linearSearchIterative(const FlatStringTable& data,
+                                             const std::string& target);
+    static SearchResult linearSearchIterative(VideoKeyView data, uint32_t target_key);
+    static SearchResult linearSearchIterative(VideoKeyView data, const std::string& target);
+    static SearchResult linearSearchSimd(VideoKeyView data, uint32_t target_key);
+    static SearchResult linearSearchSimd(VideoKeyView data, const std::string& target);
+    static SearchResult linearSearchParallel(const std::vector<std::string>& data,
+                                            const std::string& target, int threads = 0);
     static SearchResult linearSearchRecursive(const std::vector<std::string>& data, 
                                              const std::string& target);
+    static SearchResult linearSearchDivideConquer(const std::vector<std::string>& data,
+                                                 const std::string& target);
+    // One pass over the data for all targets: every element is looked up in a
+    // small open-addressing set of the targets, and the scan stops as soon as
+    // every distinct target has been seen.
+    static MultiSearchResult linearSearchMulti(const std::vector<std::string>& data,
+                                               const std::vector<std::string>& targets);
+    static MultiSearchResult linearSearchMulti(VideoKeyView data, const std::vector<std::string>& targets);
+    // Largest input the linear recursion can take without overflowing the stack.
+    static int maxRecursiveSize();
     static SearchResult runBenchmark(int data_size, const std::string& algorithm);
-    static std::vector<BenchmarkData> runPerformanceAnalysis();
+    static std::vector<BenchmarkData> runPerformanceAnalysis(const BenchmarkConfig& config = BenchmarkConfig());
+    static std::vector<LayoutBenchmarkData> runLayoutAnalysis(const BenchmarkConfig& config = BenchmarkConfig());
+    static size_t stringCatalogBytes(const std::vector<std::string>& data);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "search_engine.h"
+#include "counter_rng.h"
+#include "thread_pool.h"
+#include "test_check.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+// Every key survives formatVideoId -> parseVideoId unchanged.
+static void testVideoIdRoundTrip() {
+    for(uint32_t key : {0u, 1u, 9u, 10u, 999999u, 1000000u, 1234567u, 4294967295u}) {
+        string id = VideoKeyCatalog::formatVideoId(key);
+        uint32_t parsed = 12345;
+        CHECK(VideoKeyCatalog::parseVideoId(id, parsed));
+        CHECK(parsed == key);
+    }
+    CHECK(VideoKeyCatalog::formatVideoId(1000000) == "VID_1000000_YouTube");
+}
+
+// Only strings formatVideoId could have produced are accepted.
+static void testVideoIdRejects() {
+    uint32_t key = 0;
+    for(const char* id : {"VID__YouTube", "VID_01000000_YouTube", "VID_00_YouTube", "VID_-1_YouTube",
+                          "VID_+1_YouTube", "VID_4294967296_YouTube", "VID_12a_YouTube", "vid_1_YouTube",
+                          "VID_1_Youtube", "VID_1", "1_YouTube", ""}) {
+        CHECK(!VideoKeyCatalog::parseVideoId(id, key));
+    }
+    CHECK_THROWS(VideoKeyCatalog::fromStrings({"VID_1_YouTube", "VID_01_YouTube"}));
+}
+
+// The compact catalog finds every ID where the string catalog does, and a
+// zero-padded ID matches nothing.
+static void testCompactCatalogMatchesStrings() {
+    auto videos = LinearSearchEngine::generateVideoData(200, 3);
+    auto keys = LinearSearchEngine::generateVideoKeys(200, 3);
+    CHECK(VideoKeyCatalog::fromStrings(videos).keys == keys.keys);
+
+    for(size_t i = 0; i < videos.size(); i += 7) {
+        CHECK(keys.displayAt(i) == videos[i]);
+        auto found = LinearSearchEngine::linearSearchIterative(keys, videos[i]);
+        CHECK(found.found);
+        CHECK(found.index == static_cast<int>(i));
+    }
+
+    uint32_t first = keys.keys[0];
+    string padded = "VID_0" + to_string(first) + "_YouTube";
+    CHECK(!LinearSearchEngine::linearSearchIterative(keys, padded).found);
+    CHECK(!LinearSearchEngine::linearSearchSimd(keys, padded).found);
+}
+
+// Generation splits the catalog into one part per thread; whatever the split,
+// slot i holds 1000000 + permute(i) for the seed, as a single thread would
+// produce it.
+static void testGenerationIgnoresParallelism() {
+    const int n = 600000;     // enough for nine parts of the minimum part size
+    const uint32_t seed = 42;
+
+    RandomPermutation permutation(n, seed);
+    vector<uint32_t> expected(n);
+    for(int i = 0; i < n; i++) expected[i] = static_cast<uint32_t>(1000000 + permutation.permute(i));
+
+    vector<string> reference_titles;
+    for(int threads : {1, 2, 3, 5, 8}) {
+        setParallelism(threads);
+        CHECK(parallelism() == threads);
+
+        auto keys = LinearSearchEngine::generateVideoKeys(n, seed);
+        CHECK(keys.keys == expected);
+        auto videos = LinearSearchEngine::generateVideoData(n, seed);
+        CHECK(videos.size() == static_cast<size_t>(n));
+        CHECK(videos.front() == VideoKeyCatalog::formatVideoId(expected.front()));
+        CHECK(videos.back() == VideoKeyCatalog::formatVideoId(expected.back()));
+        CHECK(VideoKeyCatalog::fromStrings(videos).keys == expected);
+
+        auto titles = LinearSearchEngine::generateVideoTitles(n, seed);
+        if(reference_titles.empty()) reference_titles = move(titles);
+        else CHECK(titles == reference_titles);
+    }
+    setParallelism(0);
+
+    // A permutation of n consecutive IDs, and a different one for another seed.
+    vector<uint32_t> sorted = expected;
+    sort(sorted.begin(), sorted.end());
+    CHECK(sorted.front() == 1000000u && sorted.back() == 1000000u + n - 1);
+    CHECK(adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+    CHECK(LinearSearchEngine::generateVideoKeys(n, seed + 1).keys != expected);
+}
+
+int main() {
+    testVideoIdRoundTrip();
+    testVideoIdRejects();
+    testCompactCatalogMatchesStrings();
+    testGenerationIgnoresParallelism();
+    return testResult("search_engine_test");
+}
@@ -0,0 +1,205 @@
+#include "search_index.h"
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+using namespace chrono;
+
+SearchResult SearchIndex::search(uint32_t key) const {
+    SearchResult result;
+    result.algorithm = name();
+    result.target = VideoKeyCatalog::formatVideoId(key);
+    result.data_size = data_size;
+    result.comparisons = 0;
+
+    PerfScope perf;
+    auto start = high_resolution_clock::now();
+    result.index = find(key, result.comparisons);
+    auto end = high_resolution_clock::now();
+    result.counters = perf.stop();
+
+    result.execution_time_ns = duration_cast<nanoseconds>(end - start).count();
+    result.found = (result.index != -1);
+    result.build_time_ns = build_time_ns;
+    result.memory_bytes = memoryBytes();
+    return result;
+}
+
+SearchResult SearchIndex::search(const string& target) const {
+    uint32_t key;
+    if(VideoKeyCatalog::parseVideoId(target, key)) {
+        SearchResult result = search(key);
+        result.target = target;
+        return result;
+    }
+
+    // Not a video ID: nothing to look up.
+    SearchResult result;
+    result.algorithm = name();
+    result.target = target;
+    result.data_size = data_size;
+    result.comparisons = 0;
+    result.index = -1;
+    result.found = false;
+    result.execution_time_ns = 0;
+    result.build_time_ns = build_time_ns;
+    result.memory_bytes = memoryBytes();
+    return result;
+}
+
+// ---------- hash ----------
+
+void HashIndex::build(VideoKeyView data) {
+    auto start = high_resolution_clock::now();
+
+    size_t n = data.size();
+    size_t capacity = 2;
+    int bits = 1;
+    while(capacity < 2 * n) {
+        capacity <<= 1;
+        bits++;
+    }
+    shift = 64 - bits;
+    slots.assign(capacity, Slot{0, EMPTY});
+
+    size_t mask = capacity - 1;
+    for(size_t i = 0; i < n; i++) {
+        uint32_t key = data[i];
+        size_t slot = (key * 0x9E3779B97F4A7C15ull) >> shift;
+        while(slots[slot].position != EMPTY && slots[slot].key != key) {
+            slot = (slot + 1) & mask;
+        }
+        // Duplicate keys keep their first position, as a linear scan would find.
+        if(slots[slot].position == EMPTY) slots[slot] = Slot{key, static_cast<uint32_t>(i)};
+    }
+
+    data_size = static_cast<int>(n);
+    build_time_ns = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+}
+
+size_t HashIndex::memoryBytes() const {
+    return slots.capacity() * sizeof(Slot);
+}
+
+int HashIndex::find(uint32_t key, int& comparisons) const {
+    if(slots.empty()) return -1;
+
+    size_t mask = slots.size() - 1;
+    size_t slot = (key * 0x9E3779B97F4A7C15ull) >> shift;
+    while(slots[slot].position != EMPTY) {
+        comparisons++;
+        if(slots[slot].key == key) return static_cast<int>(slots[slot].position);
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+// ---------- sorted array ----------
+
+static vector<pair<uint32_t, uint32_t>> sortedKeyPositions(VideoKeyView data) {
+    vector<pair<uint32_t, uint32_t>> sorted(data.size());
+    for(size_t i = 0; i < data.size(); i++) {
+        sorted[i] = {data[i], static_cast<uint32_t>(i)};
+    }
+    // Ties sort by position, so duplicates resolve to the first occurrence.
+    sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+void SortedIndex::build(VideoKeyView data) {
+    auto start = high_resolution_clock::now();
+
+    auto sorted = sortedKeyPositions(data);
+    keys.resize(sorted.size());
+    positions.resize(sorted.size());
+    for(size_t i = 0; i < sorted.size(); i++) {
+        keys[i] = sorted[i].first;
+        positions[i] = sorted[i].second;
+    }
+
+    data_size = static_cast<int>(data.size());
+    build_time_ns = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+}
+
+size_t SortedIndex::memoryBytes() const {
+    return (keys.capacity() + positions.capacity()) * sizeof(uint32_t);
+}
+
+int SortedIndex::find(uint32_t key, int& comparisons) const {
+    size_t len = keys.size();
+    if(len == 0) return -1;
+
+    // Lower bound without a data-dependent branch: the compiler turns the
+    // ternary into a conditional move, so there is nothing to mispredict.
+    const uint32_t* base = keys.data();
+    while(len > 1) {
+        size_t half = len / 2;
+        base = (base[half] < key) ? base + half : base;
+        len -= half;
+        comparisons++;
+    }
+
+    comparisons++;
+    base += (*base < key);
+    if(base == keys.data() + keys.size() || *base != key) return -1;
+    return static_cast<int>(positions[base - keys.data()]);
+}
+
+// ---------- Eytzinger ----------
+
+size_t EytzingerIndex::fill(const vector<pair<uint32_t, uint32_t>>& sorted, size_t i, size_t k) {
+    if(k < keys.size()) {
+        i = fill(sorted, i, 2 * k);
+        keys[k] = sorted[i].first;
+        positions[k] = sorted[i].second;
+        i++;
+        i = fill(sorted, i, 2 * k + 1);
+    }
+    return i;
+}
+
+void EytzingerIndex::build(VideoKeyView data) {
+    auto start = high_resolution_clock::now();
+
+    auto sorted = sortedKeyPositions(data);
+    keys.assign(sorted.size() + 1, 0);
+    positions.assign(sorted.size() + 1, 0);
+    fill(sorted, 0, 1);
+
+    data_size = static_cast<int>(data.size());
+    build_time_ns = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+}
+
+size_t EytzingerIndex::memoryBytes() const {
+    return (keys.capacity() + positions.capacity()) * sizeof(uint32_t);
+}
+
+int EytzingerIndex::find(uint32_t key, int& comparisons) const {
+    const size_t n = keys.size() - 1;
+    const uint32_t* b = keys.data();
+
+    // Descend left on key <= node, right otherwise. 16 keys fill a cache
+    // line, so the node four levels down (index 16k) starts a line we will
+    // need soon.
+    size_t k = 1;
+    while(k <= n) {
+        __builtin_prefetch(b + k * 16);
+        k = 2 * k + (b[k] < key);
+        comparisons++;
+    }
+
+    // Undo the right turns taken after the last left turn: that node is the lower bound.
+    k >>= __builtin_ffsll(~static_cast<long long>(k));
+
+    if(k == 0) return -1;
+    comparisons++;
+    if(b[k] != key) return -1;
+    return static_cast<int>(positions[k]);
+}
+
+unique_ptr<SearchIndex> makeSearchIndex(const string& algorithm) {
+    if(algorithm == "hash") return make_unique<HashIndex>();
+    if(algorithm == "binary") return make_unique<SortedIndex>();
+    if(algorithm == "eytzinger") return make_unique<EytzingerIndex>();
+    return nullptr;
+}
@@ -0,0 +1,92 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include "search_engine.h"
+#include <memory>
+
+// Common interface for the prebuilt lookup structures. An index is built
+// once over a key catalog and then answers queries with the position the
+// key has in that catalog, like the linear scans do.
+class SearchIndex {
+public:
+    virtual ~SearchIndex() = default;
+
+    virtual const char* name() const = 0;
+    virtual const char* complexity() const = 0;
+    virtual void build(VideoKeyView data) = 0;
+    virtual size_t memoryBytes() const = 0;
+
+    SearchResult search(uint32_t key) const;
+    SearchResult search(const std::string& target) const;
+    long long buildTimeNs() const { return build_time_ns; }
+
+protected:
+    // Position of key in the catalog or -1; adds every key comparison to comparisons.
+    virtual int find(uint32_t key, int& comparisons) const = 0;
+
+    long long build_time_ns = 0;
+    int data_size = 0;
+};
+
+// Open addressing with linear probing, load factor <= 0.5.
+class HashIndex : public SearchIndex {
+public:
+    const char* name() const override { return "hash"; }
+    const char* complexity() const override { return "O(1) expected"; }
+    void build(VideoKeyView data) override;
+    size_t memoryBytes() const override;
+
+protected:
+    int find(uint32_t key, int& comparisons) const override;
+
+private:
+    struct Slot {
+        uint32_t key;
+        uint32_t position;  // EMPTY marks a free slot
+    };
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    std::vector<Slot> slots;
+    int shift = 64;
+};
+
+// Sorted keys searched with a branchless (conditional move) binary search.
+class SortedIndex : public SearchIndex {
+public:
+    const char* name() const override { return "binary"; }
+    const char* complexity() const override { return "O(log n)"; }
+    void build(VideoKeyView data) override;
+    size_t memoryBytes() const override;
+
+protected:
+    int find(uint32_t key, int& comparisons) const override;
+
+private:
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> positions;
+};
+
+// Sorted keys in breadth-first (Eytzinger) order: the top levels of the
+// implicit tree share cache lines and the search prefetches the line four
+// levels ahead.
+class EytzingerIndex : public SearchIndex {
+public:
+    const char* name() const override { return "eytzinger"; }
+    const char* complexity() const override { return "O(log n)"; }
+    void build(VideoKeyView data) override;
+    size_t memoryBytes() const override;
+
+protected:
+    int find(uint32_t key, int& comparisons) const override;
+
+private:
+    size_t fill(const std::vector<std::pair<uint32_t, uint32_t>>& sorted, size_t i, size_t k);
+
+    std::vector<uint32_t> keys;         // 1-based, keys[0] unused
+    std::vector<uint32_t> positions;
+};
+
+// "hash", "binary" or "eytzinger"; nullptr for anything else.
+std::unique_ptr<SearchIndex> makeSearchIndex(const std::string& algorithm);
+
+#endif
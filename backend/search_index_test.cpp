@@ -0,0 +1,65 @@
+#include "search_index.h"
+#include "test_check.h"
+
+using namespace std;
+
+// Every index answers every query with the position the iterative scan
+// reports, for present and absent keys alike.
+static void checkAgainstScan(const VideoKeyCatalog& catalog, const vector<uint32_t>& queries) {
+    for(const char* algorithm : {"hash", "binary", "eytzinger"}) {
+        auto index = makeSearchIndex(algorithm);
+        CHECK(index != nullptr);
+        if(!index) continue;
+        CHECK(string(index->name()) == algorithm);
+        index->build(catalog);
+
+        for(uint32_t key : queries) {
+            SearchResult scan = LinearSearchEngine::linearSearchIterative(catalog, key);
+            SearchResult indexed = index->search(key);
+            CHECK(indexed.found == scan.found);
+            CHECK(indexed.index == scan.index);
+        }
+    }
+}
+
+static void testGeneratedCatalogs() {
+    for(int n : {0, 1, 2, 3, 7, 16, 17, 1000, 4097}) {
+        VideoKeyCatalog catalog = LinearSearchEngine::generateVideoKeys(n, 11);
+        vector<uint32_t> queries = catalog.keys;
+        queries.push_back(0);
+        queries.push_back(999999);                              // just below the smallest ID
+        queries.push_back(1000000 + static_cast<uint32_t>(n));  // just above the largest
+        queries.push_back(UINT32_MAX);
+        checkAgainstScan(catalog, queries);
+    }
+}
+
+// Keys at the ends of the range and far apart, not just consecutive IDs.
+static void testExtremeKeys() {
+    VideoKeyCatalog catalog;
+    catalog.keys = {UINT32_MAX, 0, 5, 4000000000u, 1, UINT32_MAX - 1, 77};
+    vector<uint32_t> queries = catalog.keys;
+    for(uint32_t absent : {2u, 6u, 76u, 78u, 3999999999u, UINT32_MAX - 2}) queries.push_back(absent);
+    checkAgainstScan(catalog, queries);
+}
+
+static void testStringTargets() {
+    VideoKeyCatalog catalog = LinearSearchEngine::generateVideoKeys(500, 5);
+    for(const char* algorithm : {"hash", "binary", "eytzinger"}) {
+        auto index = makeSearchIndex(algorithm);
+        index->build(catalog);
+        SearchResult hit = index->search(catalog.displayAt(123));
+        CHECK(hit.found);
+        CHECK(hit.index == 123);
+        CHECK(!index->search("VID_0" + to_string(catalog.keys[123]) + "_YouTube").found);
+        CHECK(!index->search(string("not an id")).found);
+    }
+    CHECK(makeSearchIndex("iterative") == nullptr);
+}
+
+int main() {
+    testGeneratedCatalogs();
+    testExtremeKeys();
+    testStringTargets();
+    return testResult("search_index_test");
+}
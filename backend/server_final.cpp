@@ -1,102 +1,205 @@
 #include <iostream>
 #include <string>
-#include <sstream>
+#include <string_view>
+#include <charconv>
+#include <climits>
 #include <vector>
 #include <chrono>
-#include <random>
 #include <algorithm>
-#include <winsock2.h>
-#include <ws2tcpip.h>
 #include <thread>
 #include <atomic>
 #include <map>
-
-#pragma comment(lib, "ws2_32.lib")
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <random>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include "search_engine.h"
+#include "linear_search.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+#include "response_writer.h"
+#include "http_parser.h"
+#include "metrics.h"
+#include "logger.h"
+#include "dataset_cache.h"
+#include "request_coalescer.h"
 
 using namespace std;
 
-// ==================== SEARCH ENGINE ====================
-class LinearSearchEngine {
-public:
-    static vector<string> generateVideoData(int n) {
-        vector<string> videos(n);
-        for(int i = 0; i < n; i++) {
-            videos[i] = "VID_" + to_string(1000000 + i) + "_YouTube";
-        }
-        random_device rd;
-        mt19937 g(rd());
-        shuffle(videos.begin(), videos.end(), g);
-        return videos;
-    }
-    
-    static int linearSearch(const vector<string>& data, const string& target, int& comparisons) {
-        comparisons = 0;
-        for(size_t i = 0; i < data.size(); i++) {
-            comparisons++;
-            if(data[i] == target) {
-                return i;
-            }
-        }
-        return -1;
-    }
+// ==================== HTTP SERVER ====================
+struct ServerConfig {
+    int port = 8080;
+    int event_loops = 0;            // 0 = one loop per core
+    int max_connections = 10000;    // across all loops
+    int idle_timeout_ms = 30000;    // keep-alive connections idle longer than this are closed
+    int worker_threads = 0;         // search/batch workers, 0 = one per core
+    int queue_capacity = 256;       // waiting jobs before requests get 503
+    int cache_mb = 256;             // memory budget of the dataset cache
+    int result_ttl_ms = 0;          // keep search/batch results this long, 0 = only share in-flight runs
+    bool perf_counters = false;     // hardware counters per search (perf_event_open)
+    LoggerConfig log;               // request log: level, sampling, file (stdout when empty)
+};
+
+// A request head being answered. On the event loop the views point into the
+// connection's input buffer, which stays in place until the request has been
+// dispatched; pool jobs get theirs from a PooledRequest.
+struct HttpRequest {
+    string_view method;
+    string_view path;       // without the query string
+    string_view query;      // raw, still percent-encoded
+    string_view version;
+    bool keep_alive = true;
+};
+
+// What a pool job keeps of its request once the bytes have left the input
+// buffer. Only the query is copied: CPU-heavy requests are GETs to one of a
+// few fixed paths, and only whether the version is 1.1 matters.
+struct PooledRequest {
+    const char* path;
+    string query;
+    bool http11;
+    bool keep_alive;
+
+    HttpRequest view() const { return HttpRequest{"GET", path, query, http11 ? "HTTP/1.1" : "HTTP/1.0", keep_alive}; }
 };
 
-// ==================== HTTP SERVER ====================
 class SimpleApiServer {
 private:
+    static constexpr size_t MAX_HEADER_BYTES = 64 * 1024;
+    static constexpr size_t MAX_BODY_BYTES = 1024 * 1024;
+    static constexpr size_t MAX_INPUT_BYTES = MAX_HEADER_BYTES + MAX_BODY_BYTES;   // unparsed bytes per connection
+    static constexpr int MAX_EVENTS = 256;
+    static constexpr uint32_t DEFAULT_SEED = 0;  // used when a request has no seed=
+    static constexpr size_t MAX_BATCH_SIZES = 64;
+    static constexpr int MAX_BATCH_ELEMENTS = 1000000;
+    static constexpr size_t MAX_MULTI_TARGETS = 1024;
+
+    struct Connection {
+        int fd = -1;
+        bool closed = false;        // set once the loop drops it; pool jobs may still hold it
+        bool awaiting_response = false;
+        string in;                  // received bytes; in[in_start..] is not parsed yet
+        size_t in_start = 0;
+        bool input_full = false;    // stopped reading at MAX_INPUT_BYTES; the rest waits in the socket
+        HttpParser parser{MAX_HEADER_BYTES, MAX_BODY_BYTES};
+        ResponseBuffer response;    // response being written, reused across requests
+        bool has_response = false;
+        bool streaming = false;     // chunked response under way, more pieces to come
+        size_t sent = 0;            // bytes of head + body already written
+        bool close_after_write = false;
+        chrono::steady_clock::time_point last_active;
+
+        // Request being answered, for /api/metrics.
+        bool in_flight = false;
+        Endpoint endpoint = Endpoint::Other;
+        chrono::steady_clock::time_point request_start;
+        chrono::steady_clock::time_point response_ready;
+    };
+
+    // A response produced on the worker pool into conn->response, or the next
+    // piece of a streamed one, waiting to be handed back to its loop.
+    struct Completion {
+        shared_ptr<Connection> conn;
+        bool streamed = false;              // chunk goes out as part of a chunked body
+        bool last = true;
+        const char* connection_header = "";
+        string chunk{};
+        bool aborted = false;               // streamed body failed midway; close without ending it
+    };
+
+    // Every loop owns its own SO_REUSEPORT listener, epoll set and connections,
+    // so loops never share state besides the connection counter. Workers hand
+    // results back through the completion list and wake the loop via eventfd.
+    struct EventLoop {
+        int listen_fd = -1;
+        int epoll_fd = -1;
+        int wake_fd = -1;
+        unordered_map<int, shared_ptr<Connection>> connections;
+        chrono::steady_clock::time_point last_sweep;
+
+        mutex completion_mutex;
+        vector<Completion> completions;
+        vector<Completion> ready;   // drained completions, kept to reuse its capacity
+    };
+
+    // A /api/batch request whose sizes run as separate pool tasks. Results are
+    // sent in request order: whenever a task finishes, every result up to the
+    // first one still running is passed on to the loop.
+    struct BatchState {
+        EventLoop* loop;
+        shared_ptr<Connection> conn;
+        const char* connection_header;
+        bool stream;                // HTTP/1.1 gets a chunked body, 1.0 one buffered body
+
+        mutex batch_mutex;
+        vector<string> pieces;      // serialised result per size
+        vector<char> done;
+        size_t next = 0;            // first result not sent yet
+        string buffered;
+        bool failed = false;        // a size threw; nothing more is sent
+    };
+
+    ServerConfig config;
     int port;
-    SOCKET server_socket;
     atomic<bool> running;
-    
+    atomic<int> open_connections;
+    atomic<long long> rejected_connections;
+    vector<unique_ptr<EventLoop>> loops;
+    unique_ptr<WorkStealingPool> pool;
+    DatasetCache dataset_cache;
+    RequestCoalescer coalescer;
+
 public:
-    SimpleApiServer(int p = 8080) : port(p), server_socket(INVALID_SOCKET), running(false) {
-        WSADATA wsaData;
-        if(WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-            throw runtime_error("Failed to initialize Winsock");
+    explicit SimpleApiServer(const ServerConfig& cfg = ServerConfig())
+        : config(cfg), port(cfg.port), running(false), open_connections(0), rejected_connections(0),
+          dataset_cache(static_cast<size_t>(max(0, cfg.cache_mb)) * 1024 * 1024),
+          coalescer(chrono::milliseconds(max(0, cfg.result_ttl_ms))) {
+        if(config.event_loops <= 0) {
+            config.event_loops = max(1u, thread::hardware_concurrency());
+        }
+        if(config.max_connections <= 0) config.max_connections = 1;
+        if(config.worker_threads <= 0) {
+            config.worker_threads = max(1u, thread::hardware_concurrency());
         }
+        PerfCounters::setEnabled(config.perf_counters);
     }
-    
+
     ~SimpleApiServer() {
         stop();
-        WSACleanup();
+        // Workers post into the loops, so they have to be gone first.
+        if(pool) pool->shutdown();
+        close_loops();
     }
-    
+
     bool start() {
-        server_socket = socket(AF_INET, SOCK_STREAM, 0);
-        if(server_socket == INVALID_SOCKET) {
-            cerr << "Failed to create socket" << endl;
-            return false;
-        }
-        
-        int yes = 1;
-        setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, (char*)&yes, sizeof(yes));
-        
-        sockaddr_in server_addr;
-        server_addr.sin_family = AF_INET;
-        server_addr.sin_addr.s_addr = INADDR_ANY;
-        server_addr.sin_port = htons(port);
-        
-        if(bind(server_socket, (sockaddr*)&server_addr, sizeof(server_addr)) == SOCKET_ERROR) {
+        signal(SIGPIPE, SIG_IGN);
+
+        if(!bind_port(port)) {
             cerr << "Failed to bind to port " << port << endl;
             cerr << "Trying port " << port + 1 << "..." << endl;
+            close_loops();
             port++;
-            server_addr.sin_port = htons(port);
-            if(bind(server_socket, (sockaddr*)&server_addr, sizeof(server_addr)) == SOCKET_ERROR) {
-                closesocket(server_socket);
+            if(!bind_port(port)) {
+                close_loops();
                 return false;
             }
         }
-        
-        if(listen(server_socket, 10) == SOCKET_ERROR) {
-            cerr << "Failed to listen" << endl;
-            closesocket(server_socket);
-            return false;
-        }
-        
+
         running = true;
-        
+        pool = make_unique<WorkStealingPool>(config.worker_threads, config.queue_capacity);
+
         // Tampilkan info server
-        system("cls");
         cout << "================================================" << endl;
         cout << "   LINEAR SEARCH API SERVER - C++ BACKEND      " << endl;
         cout << "================================================" << endl;
@@ -106,90 +209,574 @@ public:
         cout << "3. 103072400096 - Muhammad Kelvin Firmansyah" << endl;
         cout << "================================================" << endl;
         cout << "🚀 Server started on http://localhost:" << port << endl;
+        cout << "⚙️  Event loops: " << config.event_loops
+             << " | Max connections: " << config.max_connections
+             << " | Keep-alive timeout: " << config.idle_timeout_ms << " ms" << endl;
+        cout << "⚙️  Worker threads: " << config.worker_threads
+             << " | Queue capacity: " << config.queue_capacity
+             << " | Dataset cache: " << config.cache_mb << " MB"
+             << " | Perf counters: " << (config.perf_counters ? "on" : "off") << endl;
+        cout << "📝 Log level: " << Logger::levelName(config.log.level)
+             << " | Sampling: 1 in " << max(1, config.log.sample_every)
+             << " | Log file: " << (config.log.path.empty() ? "stdout" : config.log.path) << endl;
         cout << "📡 Available endpoints:" << endl;
         cout << "  GET /api/health" << endl;
-        cout << "  GET /api/search?size=1000" << endl;
+        cout << "  GET /api/search?size=1000&algorithm=iterative|recursive|divide|simd|parallel|hash|binary|eytzinger&seed=0" << endl;
         cout << "  GET /api/complexity" << endl;
+        cout << "  GET /api/metrics" << endl;
         cout << "  GET /api/batch?sizes=100,500,1000" << endl;
+        cout << "  GET /api/multisearch?size=100000&targets=VID_1000001_YouTube,...|count=100&seed=0" << endl;
         cout << "================================================" << endl;
         cout << "Press Ctrl+C to stop server" << endl;
         cout << "================================================" << endl;
-        
+
+        vector<thread> workers;
+        for(size_t i = 1; i < loops.size(); i++) {
+            workers.emplace_back(&SimpleApiServer::run_loop, this, ref(*loops[i]));
+        }
+        run_loop(*loops[0]);
+        for(auto& t : workers) t.join();
+
+        return true;
+    }
+
+    void stop() {
+        running = false;
+    }
+
+    int get_port() const { return port; }
+
+private:
+    // ---------- socket setup ----------
+
+    bool bind_port(int p) {
+        for(int i = 0; i < config.event_loops; i++) {
+            auto loop = make_unique<EventLoop>();
+
+            loop->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if(loop->listen_fd < 0) {
+                cerr << "Failed to create socket: " << strerror(errno) << endl;
+                loops.push_back(move(loop));
+                return false;
+            }
+
+            int yes = 1;
+            setsockopt(loop->listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+            setsockopt(loop->listen_fd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes));
+
+            sockaddr_in server_addr{};
+            server_addr.sin_family = AF_INET;
+            server_addr.sin_addr.s_addr = INADDR_ANY;
+            server_addr.sin_port = htons(p);
+
+            if(bind(loop->listen_fd, (sockaddr*)&server_addr, sizeof(server_addr)) < 0 ||
+               listen(loop->listen_fd, SOMAXCONN) < 0) {
+                loops.push_back(move(loop));
+                return false;
+            }
+
+            loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            if(loop->epoll_fd < 0) {
+                cerr << "Failed to create epoll instance: " << strerror(errno) << endl;
+                loops.push_back(move(loop));
+                return false;
+            }
+
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLET;
+            ev.data.fd = loop->listen_fd;
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->listen_fd, &ev);
+
+            loop->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if(loop->wake_fd < 0) {
+                cerr << "Failed to create eventfd: " << strerror(errno) << endl;
+                loops.push_back(move(loop));
+                return false;
+            }
+            ev.events = EPOLLIN | EPOLLET;
+            ev.data.fd = loop->wake_fd;
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake_fd, &ev);
+
+            loop->last_sweep = chrono::steady_clock::now();
+            loops.push_back(move(loop));
+        }
+        return true;
+    }
+
+    void close_loops() {
+        for(auto& loop : loops) {
+            for(auto& entry : loop->connections) {
+                close(entry.first);
+                open_connections--;
+            }
+            loop->connections.clear();
+            if(loop->listen_fd >= 0) close(loop->listen_fd);
+            if(loop->epoll_fd >= 0) close(loop->epoll_fd);
+            if(loop->wake_fd >= 0) close(loop->wake_fd);
+        }
+        loops.clear();
+    }
+
+    // ---------- event loop ----------
+
+    void run_loop(EventLoop& loop) {
+        epoll_event events[MAX_EVENTS];
+
         while(running) {
-            sockaddr_in client_addr;
-            int client_size = sizeof(client_addr);
-            SOCKET client_socket = accept(server_socket, (sockaddr*)&client_addr, &client_size);
-            
-            if(client_socket == INVALID_SOCKET) {
-                if(running) {
-                    cerr << "Accept failed" << endl;
+            int n = epoll_wait(loop.epoll_fd, events, MAX_EVENTS, 1000);
+            if(n < 0) {
+                if(errno == EINTR) continue;
+                Logger::error("epoll_wait failed: %s", strerror(errno));
+                break;
+            }
+
+            for(int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if(fd == loop.listen_fd) {
+                    accept_connections(loop);
+                } else if(fd == loop.wake_fd) {
+                    drain_completions(loop);
+                } else {
+                    handle_connection_event(loop, fd, events[i].events);
                 }
+            }
+
+            close_idle_connections(loop);
+        }
+    }
+
+    void accept_connections(EventLoop& loop) {
+        // Edge-triggered: drain the accept queue completely.
+        while(true) {
+            int client_fd = accept4(loop.listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if(client_fd < 0) {
+                if(errno == EINTR || errno == ECONNABORTED) continue;
+                if(errno != EAGAIN && errno != EWOULDBLOCK) {
+                    Logger::warn("Accept failed: %s", strerror(errno));
+                }
+                return;
+            }
+
+            if(open_connections.load() >= config.max_connections) {
+                rejected_connections++;
+                close(client_fd);
                 continue;
             }
-            
-            thread(&SimpleApiServer::handle_client, this, client_socket).detach();
+
+            int yes = 1;
+            setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+            auto conn = make_shared<Connection>();
+            conn->fd = client_fd;
+            conn->last_active = chrono::steady_clock::now();
+
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.fd = client_fd;
+            if(epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+                close(client_fd);
+                continue;
+            }
+
+            open_connections++;
+            loop.connections[client_fd] = move(conn);
         }
-        
+    }
+
+    void handle_connection_event(EventLoop& loop, int fd, uint32_t events) {
+        auto it = loop.connections.find(fd);
+        if(it == loop.connections.end()) return;
+        Connection& conn = *it->second;
+        conn.last_active = chrono::steady_clock::now();
+
+        if(events & (EPOLLERR | EPOLLHUP)) {
+            close_connection(loop, fd);
+            return;
+        }
+
+        bool peer_closed = false;
+        if(events & (EPOLLIN | EPOLLRDHUP)) {
+            if(!read_input(conn, peer_closed)) {
+                close_connection(loop, fd);
+                return;
+            }
+        }
+
+        if(!serve_connection(loop, conn) || peer_closed) {
+            close_connection(loop, fd);
+        }
+    }
+
+    // Reads until the socket is drained or MAX_INPUT_BYTES are waiting to be
+    // parsed. One complete request always fits, so a full buffer can always be
+    // answered; what is left stays in the socket and TCP holds the client back
+    // until serve_connection has room again.
+    bool read_input(Connection& conn, bool& peer_closed) {
+        char buffer[16384];
+        while(true) {
+            size_t room = MAX_INPUT_BYTES - min(MAX_INPUT_BYTES, conn.in.size() - conn.in_start);
+            conn.input_full = (room == 0);
+            if(conn.input_full) return true;
+
+            ssize_t bytes_received = recv(conn.fd, buffer, min(sizeof(buffer), room), 0);
+            if(bytes_received > 0) {
+                conn.in.append(buffer, bytes_received);
+                continue;
+            }
+            if(bytes_received == 0) {
+                peer_closed = true;
+                return true;
+            }
+            if(errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+    }
+
+    // Alternates between writing the current response and answering the next
+    // buffered request until the socket is full, the input runs out or a request
+    // is out on the worker pool. Returns false when the connection should close.
+    bool serve_connection(EventLoop& loop, Connection& conn) {
+        while(true) {
+            if(!flush_output(conn)) return false;
+            if(conn.has_response) return true;          // socket full, wait for EPOLLOUT
+            if(conn.awaiting_response) return true;
+            if(conn.close_after_write) return false;
+            if(process_next_request(loop, conn)) continue;
+            if(!conn.input_full) return true;
+            if(!resume_input(conn)) return false;
+        }
+    }
+
+    // Called once every buffered request is answered: picks up the bytes left
+    // in the socket when the buffer was full, which edge-triggered epoll does
+    // not report again.
+    bool resume_input(Connection& conn) {
+        conn.in.erase(0, conn.in_start);
+        conn.in_start = 0;
+        bool peer_closed = false;
+        if(!read_input(conn, peer_closed)) return false;
+        if(peer_closed) conn.close_after_write = true;
         return true;
     }
-    
-    void stop() {
-        running = false;
-        if(server_socket != INVALID_SOCKET) {
-            closesocket(server_socket);
+
+    // Writes the pending head and body with writev, picking up after short
+    // writes. Returns false on a hard error.
+    bool flush_output(Connection& conn) {
+        ResponseBuffer& r = conn.response;
+        while(conn.has_response) {
+            size_t head_size = r.head.size();
+            size_t total = head_size + r.body.size();
+            if(conn.sent >= total) {
+                if(!conn.awaiting_response) finish_request(conn);
+                conn.has_response = false;
+                conn.sent = 0;
+                r.reset();
+                break;
+            }
+
+            iovec iov[2];
+            int count = 0;
+            if(conn.sent < head_size) {
+                iov[count++] = {r.head.data() + conn.sent, head_size - conn.sent};
+                if(!r.body.empty()) iov[count++] = {r.body.data(), r.body.size()};
+            } else {
+                iov[count++] = {r.body.data() + (conn.sent - head_size), total - conn.sent};
+            }
+
+            ssize_t written = writev(conn.fd, iov, count);
+            if(written > 0) {
+                conn.sent += written;
+                continue;
+            }
+            if(written < 0 && errno == EINTR) continue;
+            if(written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+            return false;
         }
+        return true;
     }
-    
-    int get_port() const { return port; }
-    
-private:
-    void handle_client(SOCKET client_socket) {
-        char buffer[4096];
-        int bytes_received = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-        
-        if(bytes_received > 0) {
-            buffer[bytes_received] = '\0';
-            string request(buffer);
-            string response = handle_request(request);
-            send(client_socket, response.c_str(), response.length(), 0);
+
+    void close_connection(EventLoop& loop, int fd) {
+        auto it = loop.connections.find(fd);
+        if(it != loop.connections.end()) {
+            Connection& conn = *it->second;
+            conn.closed = true;
+            // The client left before its answer was written; count it without a latency.
+            if(conn.in_flight) Metrics::requestFinished(conn.endpoint, false);
         }
-        
-        closesocket(client_socket);
+        epoll_ctl(loop.epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        loop.connections.erase(fd);
+        open_connections--;
     }
-    
-    string handle_request(const string& request) {
-        istringstream iss(request);
-        string method, path, protocol;
-        iss >> method >> path >> protocol;
-        
+
+    void drain_completions(EventLoop& loop) {
+        uint64_t counter;
+        while(read(loop.wake_fd, &counter, sizeof(counter)) > 0) {}
+
+        {
+            lock_guard<mutex> lock(loop.completion_mutex);
+            loop.ready.swap(loop.completions);
+        }
+
+        for(auto& done : loop.ready) {
+            Connection& conn = *done.conn;
+            if(conn.closed) continue;   // client went away while the job was running
+            conn.last_active = chrono::steady_clock::now();
+            if(done.streamed) {
+                ResponseBuffer& r = conn.response;
+                if(!conn.streaming) {
+                    conn.streaming = true;
+                    r.chunked = true;
+                    r.writeHead(done.connection_header);
+                }
+                if(done.aborted) {
+                    // Without the terminating chunk the client sees the body fail.
+                    r.status = "500 Internal Server Error";     // head already out; for /api/metrics
+                    conn.streaming = false;
+                    conn.awaiting_response = false;
+                    conn.close_after_write = true;
+                    mark_response_ready(conn);
+                    if(!serve_connection(loop, conn)) close_connection(loop, conn.fd);
+                    continue;
+                }
+                r.appendChunk(done.chunk);
+                if(done.last) {
+                    r.appendChunk({});
+                    conn.streaming = false;
+                    conn.awaiting_response = false;
+                }
+            } else {
+                conn.awaiting_response = false;
+                conn.sent = 0;
+            }
+            mark_response_ready(conn);
+
+            // Requests pipelined behind the deferred one can run now.
+            if(!serve_connection(loop, conn)) {
+                close_connection(loop, conn.fd);
+            }
+        }
+        loop.ready.clear();
+    }
+
+    void post_completion(EventLoop& loop, Completion done) {
+        {
+            lock_guard<mutex> lock(loop.completion_mutex);
+            loop.completions.push_back(move(done));
+        }
+        uint64_t one = 1;
+        ssize_t written = write(loop.wake_fd, &one, sizeof(one));
+        (void)written;
+    }
+
+    void close_idle_connections(EventLoop& loop) {
+        auto now = chrono::steady_clock::now();
+        if(now - loop.last_sweep < chrono::seconds(1)) return;
+        loop.last_sweep = now;
+
+        auto timeout = chrono::milliseconds(config.idle_timeout_ms);
+        vector<int> idle;
+        for(auto& entry : loop.connections) {
+            if(entry.second->awaiting_response) continue;
+            if(now - entry.second->last_active > timeout) idle.push_back(entry.first);
+        }
+        for(int fd : idle) close_connection(loop, fd);
+    }
+
+    // ---------- HTTP framing ----------
+
+    // Answers the oldest complete request in the input buffer into conn.response.
+    // Pipelined requests are taken one at a time once the previous response has
+    // been written, so responses keep their order and one buffer per connection
+    // is enough. Returns false when no complete request is buffered.
+    bool process_next_request(EventLoop& loop, Connection& conn) {
+        auto parse_start = chrono::steady_clock::now();
+        HttpRequestView view;
+        ParseStatus status = conn.parser.parse(string_view(conn.in).substr(conn.in_start), view);
+        if(status == ParseStatus::Incomplete) {
+            // Move the partial request to the front once, instead of erasing
+            // every answered request as it is taken off the buffer.
+            conn.in.erase(0, conn.in_start);
+            conn.in_start = 0;
+            return false;
+        }
+        if(status != ParseStatus::Complete) {
+            conn.response.status = (status == ParseStatus::HeadTooLarge) ? "431 Request Header Fields Too Large"
+                                 : (status == ParseStatus::BodyTooLarge) ? "413 Payload Too Large"
+                                 : (status == ParseStatus::UnsupportedFraming) ? "501 Not Implemented"
+                                 : "400 Bad Request";
+            conn.response.content_type = nullptr;
+            conn.response.writeHead("Connection: close\r\n");
+            begin_request(conn, Endpoint::Other, chrono::steady_clock::now());
+            mark_response_ready(conn);
+            conn.close_after_write = true;
+            conn.in.clear();
+            conn.in_start = 0;
+            return true;
+        }
+
+        HttpRequest req{view.method, view.path, view.query, view.version, view.keep_alive};
+
+        begin_request(conn, Metrics::endpointFor(req.method, req.path), parse_start);
+        Metrics::recordPhase(conn.endpoint, Phase::Parse, elapsed_ns(parse_start));
+
+        if(!req.keep_alive) conn.close_after_write = true;
+
+        bool queued = false;
+        if(const char* path = cpu_heavy_path(req)) {
+            queued = submit_to_pool(loop, conn,
+                                    PooledRequest{path, string(req.query), req.version == "HTTP/1.1", req.keep_alive});
+            if(!queued) writeBusyResponse(conn.response);
+        } else {
+            handle_request(req, conn.response);
+        }
+        if(queued) {
+            conn.awaiting_response = true;
+        } else {
+            conn.response.writeHead(connection_header(req));
+            mark_response_ready(conn);
+            conn.sent = 0;
+        }
+
+        // req is done with the buffer now.
+        conn.in_start += view.size();
+        if(conn.in_start == conn.in.size()) {
+            conn.in.clear();
+            conn.in_start = 0;
+        }
+        return true;
+    }
+
+    void begin_request(Connection& conn, Endpoint endpoint, chrono::steady_clock::time_point start) {
+        conn.in_flight = true;
+        conn.endpoint = endpoint;
+        conn.request_start = start;
+        conn.response_ready = chrono::steady_clock::time_point();
+        Metrics::requestStarted(endpoint);
+    }
+
+    // Called for every piece of a streamed response; the send phase starts with the first.
+    static void mark_response_ready(Connection& conn) {
+        conn.has_response = true;
+        if(conn.response_ready == chrono::steady_clock::time_point()) {
+            conn.response_ready = chrono::steady_clock::now();
+        }
+    }
+
+    static void finish_request(Connection& conn) {
+        if(!conn.in_flight) return;
+        conn.in_flight = false;
+        auto now = chrono::steady_clock::now();
+        Metrics::recordPhase(conn.endpoint, Phase::Send,
+                             chrono::duration_cast<chrono::nanoseconds>(now - conn.response_ready).count());
+        Metrics::recordPhase(conn.endpoint, Phase::Total,
+                             chrono::duration_cast<chrono::nanoseconds>(now - conn.request_start).count());
+        Metrics::requestFinished(conn.endpoint, conn.response.status[0] >= '4');
+    }
+
+    static long long elapsed_ns(chrono::steady_clock::time_point start) {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    }
+
+    // Search and batch requests generate and scan whole datasets; they run on the
+    // worker pool so event loops keep serving I/O. Returns the path as a literal
+    // that outlives the request, or nullptr for requests answered on the loop.
+    static const char* cpu_heavy_path(const HttpRequest& req) {
+        if(req.method != "GET") return nullptr;
+        for(const char* path : {"/api/search", "/api/batch", "/api/multisearch"}) {
+            if(req.path == path) return path;
+        }
+        return nullptr;
+    }
+
+    // The worker writes straight into the connection's response buffer: the loop
+    // leaves it alone while awaiting_response is set, and the shared_ptr keeps it
+    // alive if the client disconnects before the job finishes.
+    bool submit_to_pool(EventLoop& loop, Connection& conn, PooledRequest pooled) {
+        shared_ptr<Connection> target_conn = loop.connections.at(conn.fd);
+        EventLoop* target = &loop;
+
+        return pool->trySubmit([this, target, target_conn, pooled = move(pooled)]() {
+            HttpRequest req = pooled.view();
+            if(req.path == "/api/batch") {
+                start_batch(*target, target_conn, req);
+                return;
+            }
+            string error;
+            if(!answerOrFail(target_conn->response, error, [&](ResponseBuffer& out) { handle_request(req, out); })) {
+                Logger::error("[API] %.*s failed: %s", static_cast<int>(req.path.size()), req.path.data(),
+                              error.c_str());
+            }
+            target_conn->response.writeHead(connection_header(req));
+            post_completion(*target, Completion{target_conn});
+        });
+    }
+
+    static const char* connection_header(const HttpRequest& req) {
+        if(!req.keep_alive) return "Connection: close\r\n";
+        if(req.version != "HTTP/1.1") return "Connection: keep-alive\r\n";
+        return "";
+    }
+
+    // ---------- API ----------
+
+    void handle_request(const HttpRequest& req, ResponseBuffer& out) {
+        string_view method = req.method;
+        string_view path = req.path;
+
         // Log request
-        cout << "[API] " << method << " " << path << endl;
-        
+        log_request(req);
+
         // Handle CORS preflight
         if(method == "OPTIONS") {
-            return "HTTP/1.1 200 OK\r\n"
-                   "Access-Control-Allow-Origin: *\r\n"
-                   "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-                   "Access-Control-Allow-Headers: Content-Type\r\n"
-                   "Content-Length: 0\r\n\r\n";
+            out.content_type = nullptr;
+            out.extra_headers = "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
+                                "Access-Control-Allow-Headers: Content-Type\r\n";
+            return;
         }
-        
+
         // Handle GET requests
         if(method == "GET") {
             if(path == "/api/health") {
-                return create_json_response(R"({
-                    "status": "healthy",
-                    "service": "Linear Search API",
-                    "version": "1.0.0",
-                    "timestamp": ")" + get_current_time() + R"(",
-                    "endpoints": ["/api/health", "/api/search", "/api/complexity", "/api/batch"]
-                })");
+                char timestamp[64];
+                JsonWriter json(out.body);
+                json.beginObject()
+                    .field("status", "healthy")
+                    .field("service", "Linear Search API")
+                    .field("version", "1.0.0")
+                    .field("timestamp", get_current_time(timestamp, sizeof(timestamp)))
+                    .field("open_connections", open_connections.load())
+                    .field("rejected_connections", rejected_connections.load())
+                    .field("log_dropped", Logger::dropped());
+                json.key("worker_pool");
+                write_pool_stats(json);
+                json.key("dataset_cache");
+                write_cache_stats(json);
+                json.key("request_coalescer");
+                write_coalescer_stats(json);
+                json.key("endpoints").beginArray()
+                    .value("/api/health").value("/api/search").value("/api/complexity").value("/api/batch")
+                    .value("/api/multisearch").value("/api/metrics")
+                    .endArray();
+                json.endObject();
+                return;
             }
-            else if(path.find("/api/search") == 0) {
-                return handle_search_request(path);
+            else if(path == "/api/search") {
+                handle_search_request(req.query, out);
+                return;
+            }
+            else if(path == "/api/multisearch") {
+                handle_multisearch_request(req.query, out);
+                return;
+            }
+            else if(path == "/api/metrics") {
+                out.content_type = "text/plain; version=0.0.4";
+                Metrics::render(out.body);
+                write_server_gauges(out.body);
+                return;
             }
             else if(path == "/api/complexity") {
-                return create_json_response(R"({
+                out.body += R"({
                     "algorithm": "Linear Search",
                     "description": "Search through list sequentially",
                     "time_complexity": {
@@ -199,7 +786,8 @@ private:
                     },
                     "space_complexity": {
                         "iterative": "O(1) - constant space",
-                        "recursive": "O(n) - call stack depth"
+                        "recursive": "O(n) - call stack depth, O(1) once the tail call is eliminated",
+                        "divide_and_conquer": "O(log n) - call stack depth"
                     },
                     "characteristics": [
                         "Simple to implement",
@@ -207,181 +795,533 @@ private:
                         "No preprocessing needed",
                         "Good for small datasets"
                     ]
-                })");
-            }
-            else if(path.find("/api/batch") == 0) {
-                return handle_batch_request(path);
+                })";
+                return;
             }
         }
-        
+
         // 404 Not Found
-        return "HTTP/1.1 404 Not Found\r\n"
-               "Content-Type: application/json\r\n"
-               "Access-Control-Allow-Origin: *\r\n\r\n"
-               "{\"error\":\"Endpoint not found\"}";
+        writeErrorResponse(out, "404 Not Found", "Endpoint not found");
     }
-    
-    string handle_search_request(const string& path) {
-        int size = 1000;
-        
+
+    void handle_search_request(string_view query, ResponseBuffer& out) {
         // Parse query parameters
-        size_t qmark = path.find('?');
-        if(qmark != string::npos) {
-            string query = path.substr(qmark + 1);
-            size_t size_pos = query.find("size=");
-            if(size_pos != string::npos) {
-                size_t start = size_pos + 5;
-                size_t end = query.find('&', start);
-                if(end == string::npos) end = query.length();
-                string size_str = query.substr(start, end - start);
-                try {
-                    size = stoi(size_str);
-                } catch(...) {
-                    size = 1000;
-                }
-            }
-        }
+        int size = get_int_param(query, "size", 1000);
+        string algorithm = queryParam(query, "algorithm");
+        if(algorithm.empty()) algorithm = "iterative";
+        uint32_t seed = get_seed_param(query);
         
         // Validate size
         if(size > 100000) size = 100000;
         if(size < 10) size = 10;
         
-        // Run benchmark
-        auto start_time = chrono::high_resolution_clock::now();
-        auto videos = LinearSearchEngine::generateVideoData(size);
-        string target = videos[size / 2];
-        int comparisons = 0;
-        
-        int index = LinearSearchEngine::linearSearch(videos, target, comparisons);
-        bool found = (index != -1);
+        bool indexed = (algorithm == "hash" || algorithm == "binary" || algorithm == "eytzinger");
+        if(!indexed && algorithm != "iterative" && algorithm != "recursive" && algorithm != "divide" &&
+           algorithm != "simd" && algorithm != "parallel" && algorithm != "flat") {
+            writeErrorResponse(out, "400 Bad Request",
+                               "Unknown algorithm, use iterative, recursive, divide, simd, "
+                               "parallel, flat, hash, binary or eytzinger");
+            return;
+        }
+        string catalog = queryParam(query, "catalog");
+        if(catalog.empty()) catalog = "ids";
+        if(catalog != "ids" && catalog != "titles") {
+            writeErrorResponse(out, "400 Bad Request", "Unknown catalog, use ids or titles");
+            return;
+        }
+        CatalogKind kind = (catalog == "titles") ? CatalogKind::Titles : CatalogKind::Ids;
+        if(kind == CatalogKind::Titles && (indexed || algorithm == "simd")) {
+            writeErrorResponse(out, "400 Bad Request",
+                               "Titles have no numeric key, use iterative, recursive, divide, "
+                               "parallel or flat");
+            return;
+        }
+        if(algorithm == "recursive" && size > LinearSearchEngine::maxRecursiveSize()) {
+            writeErrorResponse(out, "400 Bad Request",
+                               "Recursive search is limited to " +
+                               to_string(LinearSearchEngine::maxRecursiveSize()) +
+                               " elements in this build");
+            return;
+        }
+
+        // Identical concurrent searches share one run (and, with --result-ttl-ms, its result).
+        RequestKey key;
+        key.add("search ").add(size).add(" ").add(algorithm).add(" ").add(catalog).add(" ").add(seed);
+        coalescer.run(key, out.body, [&](string& body) { run_search(size, algorithm, catalog, kind, seed, body); });
+    }
+
+    // Generates or fetches the dataset, runs one search and appends the JSON body.
+    // The reported time covers the search only, not data generation.
+    void run_search(int size, const string& algorithm, const string& catalog, CatalogKind kind, uint32_t seed,
+                    string& body) {
+        SearchResult result;
+        long long iterative_time_ns = 0;
+        bool indexed = (algorithm == "hash" || algorithm == "binary" || algorithm == "eytzinger");
+
+        auto generate_start = chrono::steady_clock::now();
+        auto dataset = dataset_cache.get(size, seed, kind);
+        Metrics::recordPhase(Endpoint::Search, Phase::Generate, elapsed_ns(generate_start));
+        const vector<string>& videos = dataset->videos;
+        const string& target = videos[size / 2];
+
+        const char* complexity = "O(n)";
+        shared_ptr<const FlatStringTable> flat;
+        if(indexed) {
+            auto index = dataset_cache.index(dataset, algorithm);
+            result = index->search(target);
+            complexity = index->complexity();
+        }
+        else if(algorithm == "simd") {
+            result = LinearSearchEngine::linearSearchSimd(dataset->keys, target);
+        }
+        else if(algorithm == "flat") {
+            flat = dataset_cache.flat(dataset);
+            result = LinearSearchEngine::linearSearchIterative(*flat, target);
+        }
+        else if(algorithm == "parallel") {
+            // Warm the caches first so neither timing pays for the first touch.
+            LinearSearch<string>().iterative(videos, target);
+            auto baseline = LinearSearchEngine::linearSearchIterative(videos, target);
+            result = LinearSearchEngine::linearSearchParallel(videos, target);
+            result.speedup = static_cast<double>(baseline.execution_time_ns) /
+                             max(1LL, result.execution_time_ns);
+            iterative_time_ns = baseline.execution_time_ns;
+        }
+        else if(algorithm == "recursive") {
+            result = LinearSearchEngine::linearSearchRecursive(videos, target);
+        }
+        else if(algorithm == "divide") {
+            result = LinearSearchEngine::linearSearchDivideConquer(videos, target);
+        }
+        else {
+            result = LinearSearchEngine::linearSearchIterative(videos, target);
+        }
         
-        auto end_time = chrono::high_resolution_clock::now();
-        auto duration_ns = chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
+        long long duration_ns = result.execution_time_ns;
+        Metrics::recordPhase(Endpoint::Search, Phase::Search, duration_ns);
         
         // Build JSON response
-        string json = "{";
-        json += "\"success\": true,";
-        json += "\"data_size\": " + to_string(size) + ",";
-        json += "\"algorithm\": \"iterative\","; 
-        json += "\"execution_time_ns\": " + to_string(duration_ns) + ",";
-        json += "\"execution_time_ms\": " + to_string(duration_ns / 1000000.0) + ",";
-        json += "\"comparisons\": " + to_string(comparisons) + ",";
-        json += "\"found\": " + string(found ? "true" : "false") + ",";
-        json += "\"index\": " + to_string(index) + ",";
-        json += "\"complexity\": \"O(n)\"";
-        json += "}";
-        
-        return create_json_response(json);
+        JsonWriter json(body);
+        json.beginObject()
+            .field("success", true)
+            .field("data_size", size)
+            .field("algorithm", result.algorithm)
+            .field("catalog", catalog)
+            .field("seed", seed);
+        if(algorithm == "simd") {
+            json.field("simd_level", simdLevelName(detectSimdLevel()));
+        }
+        if(algorithm == "parallel") {
+            json.field("threads", result.thread_comparisons.size());
+            json.key("thread_comparisons").beginArray();
+            for(int c : result.thread_comparisons) json.value(c);
+            json.endArray();
+            json.field("iterative_time_ns", iterative_time_ns)
+                .field("speedup", result.speedup);
+        }
+        json.field("execution_time_ns", duration_ns)
+            .field("execution_time_ms", duration_ns / 1000000.0)
+            .field("comparisons", result.comparisons)
+            .field("found", result.found)
+            .field("index", result.index);
+        if(indexed) {
+            json.field("build_time_ns", result.build_time_ns)
+                .field("memory_bytes", result.memory_bytes);
+        }
+        if(algorithm == "flat") {
+            json.field("memory_bytes", flat->memoryBytes())
+                .field("string_memory_bytes", LinearSearchEngine::stringCatalogBytes(videos));
+        }
+        if(PerfCounters::enabled()) {
+            json.key("perf");
+            write_perf(json, result.counters);
+        }
+        json.field("complexity", complexity);
+        json.endObject();
     }
     
-    string handle_batch_request(const string& path) {
-        vector<int> sizes = {10, 100, 500, 1000, 5000};
-        
-        // Parse custom sizes
-        size_t qmark = path.find('?');
-        if(qmark != string::npos) {
-            string query = path.substr(qmark + 1);
-            size_t sizes_pos = query.find("sizes=");
-            if(sizes_pos != string::npos) {
-                sizes.clear();
-                size_t start = sizes_pos + 6;
-                size_t end = query.find('&', start);
-                if(end == string::npos) end = query.length();
-                string sizes_str = query.substr(start, end - start);
-                
-                stringstream ss(sizes_str);
-                string token;
-                while(getline(ss, token, ',')) {
-                    try {
-                        sizes.push_back(stoi(token));
-                    } catch(...) {
-                        // Skip invalid numbers
-                    }
-                }
+    // Looks up many IDs in one pass and compares that with scanning once per ID.
+    // Targets come from targets=ID,ID,... or, without it, count= IDs drawn from
+    // the dataset with the request's seed.
+    void handle_multisearch_request(string_view query, ResponseBuffer& out) {
+        int size = get_int_param(query, "size", 100000);
+        if(size > 100000) size = 100000;
+        if(size < 10) size = 10;
+        uint32_t seed = get_seed_param(query);
+
+        auto generate_start = chrono::steady_clock::now();
+        auto dataset = dataset_cache.get(size, seed);
+        Metrics::recordPhase(Endpoint::MultiSearch, Phase::Generate, elapsed_ns(generate_start));
+        const vector<string>& videos = dataset->videos;
+
+        vector<string> targets;
+        string targets_str = queryParam(query, "targets");
+        if(!targets_str.empty()) {
+            string_view rest(targets_str);
+            while(!rest.empty() && targets.size() < MAX_MULTI_TARGETS) {
+                size_t comma = min(rest.find(','), rest.size());
+                if(comma > 0) targets.emplace_back(rest.substr(0, comma));
+                rest.remove_prefix(min(comma + 1, rest.size()));
             }
+        } else {
+            size_t count = static_cast<size_t>(max(1, get_int_param(query, "count", 100)));
+            count = min(count, MAX_MULTI_TARGETS);
+            mt19937 g(seed);
+            uniform_int_distribution<int> pick(0, size - 1);
+            for(size_t t = 0; t < count; t++) targets.push_back(videos[pick(g)]);
         }
-        
-        // Limit sizes
-        if(sizes.size() > 10) sizes.resize(10);
-        for(auto& s : sizes) {
-            if(s > 50000) s = 50000;
-            if(s < 1) s = 10;
+        if(targets.empty()) {
+            writeErrorResponse(out, "400 Bad Request", "No targets given");
+            return;
         }
-        
-        // Build results array
-        string results_array = "[";
+
+        MultiSearchResult result = LinearSearchEngine::linearSearchMulti(dataset->keys, targets);
+        Metrics::recordPhase(Endpoint::MultiSearch, Phase::Search, result.execution_time_ns);
+
+        long long separate_time_ns = 0;
+        long long separate_comparisons = 0;
+        for(const auto& target : targets) {
+            auto single = LinearSearchEngine::linearSearchIterative(dataset->keys, target);
+            separate_time_ns += single.execution_time_ns;
+            separate_comparisons += single.comparisons;
+        }
+
+        JsonWriter json(out.body);
+        json.beginObject()
+            .field("success", true)
+            .field("data_size", size)
+            .field("algorithm", result.algorithm)
+            .field("seed", seed)
+            .field("targets", targets.size())
+            .field("found", result.found_count)
+            .field("execution_time_ns", result.execution_time_ns)
+            .field("elements_scanned", result.elements_scanned)
+            .field("elements_per_sec", result.elements_scanned * 1e9 / max(1LL, result.execution_time_ns))
+            .field("separate_scans_time_ns", separate_time_ns)
+            .field("separate_comparisons", separate_comparisons)
+            .field("speedup", static_cast<double>(separate_time_ns) / max(1LL, result.execution_time_ns));
+        if(PerfCounters::enabled()) {
+            json.key("perf");
+            write_perf(json, result.counters);
+        }
+        json.key("results").beginArray();
+        for(const auto& hit : result.hits) {
+            json.beginObject()
+                .field("target", hit.target)
+                .field("index", hit.index)
+                .field("comparisons", hit.comparisons)
+                .field("found", hit.found)
+                .endObject();
+        }
+        json.endArray();
+        json.endObject();
+    }
+
+    // Up to MAX_BATCH_SIZES sizes from sizes=, each clamped to 10..MAX_BATCH_ELEMENTS.
+    static vector<int> parse_batch_sizes(string_view query) {
+        string sizes_str = queryParam(query, "sizes");
+        if(sizes_str.empty()) return {10, 100, 500, 1000, 5000};
+
+        vector<int> sizes;
+        string_view rest(sizes_str);
+        while(!rest.empty() && sizes.size() < MAX_BATCH_SIZES) {
+            size_t comma = min(rest.find(','), rest.size());
+            string_view token = rest.substr(0, comma);
+            rest.remove_prefix(min(comma + 1, rest.size()));
+
+            long long s;
+            auto res = from_chars(token.data(), token.data() + token.size(), s);
+            if(res.ec != errc() || res.ptr == token.data()) continue;   // skip invalid numbers
+            if(s > MAX_BATCH_ELEMENTS) s = MAX_BATCH_ELEMENTS;
+            if(s < 10) s = 10;
+            sizes.push_back(static_cast<int>(s));
+        }
+        return sizes;
+    }
+
+    // Runs on the pool. Every size becomes its own task so a sweep uses all
+    // workers; a task the queue has no room for runs right here instead.
+    void start_batch(EventLoop& loop, shared_ptr<Connection> conn, const HttpRequest& req) {
+        log_request(req);
+
+        vector<int> sizes;
+        uint32_t seed;
+        auto batch = make_shared<BatchState>();
+        string opening;
+        try {
+            sizes = parse_batch_sizes(req.query);
+            seed = get_seed_param(req.query);
+
+            batch->loop = &loop;
+            batch->conn = conn;
+            batch->connection_header = connection_header(req);
+            batch->stream = (req.version == "HTTP/1.1");
+            batch->pieces.resize(sizes.size());
+            batch->done.assign(sizes.size(), 0);
+
+            JsonWriter json(opening);
+            json.beginObject()
+                .field("success", true)
+                .field("sizes_tested", sizes.size())
+                .field("seed", seed)
+                .key("results").beginArray();
+        } catch(const exception& e) {
+            Logger::error("[API] /api/batch failed: %s", e.what());
+            writeInternalErrorResponse(conn->response);
+            conn->response.writeHead(connection_header(req));
+            post_completion(loop, Completion{conn});
+            return;
+        }
+        {
+            lock_guard<mutex> lock(batch->batch_mutex);
+            if(sizes.empty()) opening += "]}";
+            emit_batch_piece(*batch, move(opening), sizes.empty());
+        }
+
         for(size_t i = 0; i < sizes.size(); i++) {
             int size = sizes[i];
-            auto videos = LinearSearchEngine::generateVideoData(size);
-            string target = videos[size / 2];
-            int comparisons = 0;
-            
-            auto start = chrono::high_resolution_clock::now();
-            LinearSearchEngine::linearSearch(videos, target, comparisons);
-            auto end = chrono::high_resolution_clock::now();
-            auto duration_ns = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
-            
-            if(i > 0) results_array += ",";
-            results_array += "{";
-            results_array += "\"size\": " + to_string(size) + ",";
-            results_array += "\"time_ns\": " + to_string(duration_ns) + ",";
-            results_array += "\"comparisons\": " + to_string(comparisons);
-            results_array += "}";
-        }
-        results_array += "]";
-        
-        string json = "{";
-        json += "\"success\": true,";
-        json += "\"sizes_tested\": " + to_string(sizes.size()) + ",";
-        json += "\"results\": " + results_array;
-        json += "}";
-        
-        return create_json_response(json);
+            auto task = [this, batch, i, size, seed]() { run_batch_item(*batch, i, size, seed); };
+            if(!pool->trySubmit(task)) task();
+        }
     }
-    
-    string create_json_response(const string& json) {
-        string response = "HTTP/1.1 200 OK\r\n";
-        response += "Content-Type: application/json\r\n";
-        response += "Access-Control-Allow-Origin: *\r\n";
-        response += "Content-Length: " + to_string(json.length()) + "\r\n";
-        response += "\r\n";
-        response += json;
-        return response;
+
+    // Identical sizes of concurrent batches share one run through the coalescer.
+    void run_batch_item(BatchState& batch, size_t i, int size, uint32_t seed) {
+        RequestKey key;
+        key.add("batch ").add(size).add(" ").add(seed);
+        string piece;
+        try {
+            coalescer.run(key, piece, [this, size, seed](string& json) {
+                auto generate_start = chrono::steady_clock::now();
+                auto dataset = dataset_cache.get(size, seed);
+                Metrics::recordPhase(Endpoint::Batch, Phase::Generate, elapsed_ns(generate_start));
+                const vector<string>& videos = dataset->videos;
+                auto result = LinearSearchEngine::linearSearchIterative(videos, videos[size / 2]);
+                Metrics::recordPhase(Endpoint::Batch, Phase::Search, result.execution_time_ns);
+
+                JsonWriter(json).beginObject()
+                    .field("size", size)
+                    .field("time_ns", result.execution_time_ns)
+                    .field("comparisons", result.comparisons)
+                    .endObject();
+            });
+        } catch(const exception& e) {
+            Logger::error("[API] /api/batch size %d failed: %s", size, e.what());
+            fail_batch(batch);
+            return;
+        }
+
+        lock_guard<mutex> lock(batch.batch_mutex);
+        if(batch.failed) return;
+        batch.pieces[i] = move(piece);
+        batch.done[i] = 1;
+
+        string ready;
+        while(batch.next < batch.done.size() && batch.done[batch.next]) {
+            if(batch.next > 0) ready += ',';
+            ready += batch.pieces[batch.next];
+            batch.pieces[batch.next] = string();
+            batch.next++;
+        }
+        if(ready.empty()) return;
+        bool last = (batch.next == batch.done.size());
+        if(last) ready += "]}";
+        emit_batch_piece(batch, move(ready), last);
     }
-    
-    string get_current_time() {
-        auto now = chrono::system_clock::now();
-        time_t now_time = chrono::system_clock::to_time_t(now);
-        char buffer[80];
-        ctime_s(buffer, sizeof(buffer), &now_time);
-        string time_str(buffer);
-        time_str.pop_back();
+
+    // Caller holds batch_mutex, which keeps the pieces in order on their way to the loop.
+    void emit_batch_piece(BatchState& batch, string piece, bool last) {
+        if(batch.stream) {
+            post_completion(*batch.loop,
+                            Completion{batch.conn, true, last, batch.connection_header, move(piece)});
+            return;
+        }
+        batch.buffered += piece;
+        if(!last) return;
+        ResponseBuffer& out = batch.conn->response;
+        out.body = move(batch.buffered);
+        out.writeHead(batch.connection_header);
+        post_completion(*batch.loop, Completion{batch.conn});
+    }
+
+    // A streamed batch has already sent its head, so it is cut short and the
+    // connection closed; a buffered one is answered with a 500 instead.
+    void fail_batch(BatchState& batch) {
+        lock_guard<mutex> lock(batch.batch_mutex);
+        if(batch.failed) return;
+        batch.failed = true;
+        if(batch.stream) {
+            post_completion(*batch.loop, Completion{batch.conn, true, true, batch.connection_header, {}, true});
+            return;
+        }
+        writeInternalErrorResponse(batch.conn->response);
+        batch.conn->response.writeHead(batch.connection_header);
+        post_completion(*batch.loop, Completion{batch.conn});
+    }
+
+    // Integer query parameter, or fallback when it is absent or not a number.
+    static int get_int_param(string_view query, const char* name, int fallback) {
+        long long value;
+        if(!queryInt(query, name, value) || value < INT_MIN || value > INT_MAX) return fallback;
+        return static_cast<int>(value);
+    }
+
+    static uint32_t get_seed_param(string_view query) {
+        long long value;
+        if(!queryInt(query, "seed", value) || value < 0 || value > UINT32_MAX) return DEFAULT_SEED;
+        return static_cast<uint32_t>(value);
+    }
+
+    static void log_request(const HttpRequest& req) {
+        Logger::info("[API] %.*s %.*s%s%.*s", static_cast<int>(req.method.size()), req.method.data(),
+                     static_cast<int>(req.path.size()), req.path.data(), req.query.empty() ? "" : "?",
+                     static_cast<int>(req.query.size()), req.query.data());
+    }
+
+    void write_pool_stats(JsonWriter& json) {
+        PoolStats s = pool->stats();
+        json.beginObject()
+            .field("threads", s.threads)
+            .field("queue_depth", s.queue_depth)
+            .field("queue_capacity", s.queue_capacity)
+            .field("active", s.active)
+            .field("completed", s.completed)
+            .field("rejected", s.rejected)
+            .field("steals", s.steals)
+            .endObject();
+    }
+
+    // Server-wide gauges and counters that live outside Metrics, in the same text format.
+    void write_server_gauges(string& out) {
+        PoolStats p = pool->stats();
+        DatasetCacheStats c = dataset_cache.stats();
+        RequestCoalescerStats r = coalescer.stats();
+        auto sample = [&out](const char* name, const char* type, long long value) {
+            out += "# TYPE ";
+            out += name;
+            out += ' ';
+            out += type;
+            out += '\n';
+            out += name;
+            out += ' ';
+            out += to_string(value);
+            out += '\n';
+        };
+        sample("linear_search_open_connections", "gauge", open_connections.load());
+        sample("linear_search_rejected_connections_total", "counter", rejected_connections.load());
+        sample("linear_search_worker_queue_depth", "gauge", p.queue_depth);
+        sample("linear_search_worker_active", "gauge", p.active);
+        sample("linear_search_worker_rejected_total", "counter", p.rejected);
+        sample("linear_search_dataset_cache_hits_total", "counter", c.hits);
+        sample("linear_search_dataset_cache_misses_total", "counter", c.misses);
+        sample("linear_search_dataset_cache_bytes", "gauge", c.bytes);
+        sample("linear_search_result_cache_hits_total", "counter", r.hits);
+        sample("linear_search_result_cache_misses_total", "counter", r.misses);
+        sample("linear_search_result_coalesced_total", "counter", r.coalesced);
+        sample("linear_search_result_cache_entries", "gauge", r.entries);
+        sample("linear_search_log_dropped_total", "counter", Logger::dropped());
+        sample("linear_search_log_sampled_out_total", "counter", Logger::sampledOut());
+    }
+
+    static void write_perf(JsonWriter& json, const PerfCounterValues& c) {
+        json.beginObject().field("available", c.available);
+        if(!c.available) {
+            json.field("status", PerfCounters::status());
+        } else {
+            json.field("cycles", c.cycles)
+                .field("instructions", c.instructions)
+                .field("l1d_misses", c.l1d_misses)
+                .field("llc_misses", c.llc_misses)
+                .field("branch_misses", c.branch_misses);
+        }
+        json.endObject();
+    }
+
+    void write_cache_stats(JsonWriter& json) {
+        DatasetCacheStats s = dataset_cache.stats();
+        json.beginObject()
+            .field("hits", s.hits)
+            .field("misses", s.misses)
+            .field("evictions", s.evictions)
+            .field("entries", s.entries)
+            .field("bytes", s.bytes)
+            .field("budget_bytes", s.budget_bytes)
+            .endObject();
+    }
+
+    void write_coalescer_stats(JsonWriter& json) {
+        RequestCoalescerStats s = coalescer.stats();
+        json.beginObject()
+            .field("hits", s.hits)
+            .field("misses", s.misses)
+            .field("coalesced", s.coalesced)
+            .field("entries", s.entries)
+            .field("ttl_ms", s.ttl_ms)
+            .endObject();
+    }
+
+    // ctime_r into a caller buffer (at least 26 bytes), without the trailing newline.
+    static string_view get_current_time(char* buffer, size_t size) {
+        if(size < 26) return {};
+        time_t now_time = chrono::system_clock::to_time_t(chrono::system_clock::now());
+        ctime_r(&now_time, buffer);
+        string_view time_str(buffer);
+        if(!time_str.empty() && time_str.back() == '\n') time_str.remove_suffix(1);
         return time_str;
     }
 };
 
 // ==================== MAIN ====================
-int main() {
+int main(int argc, char* argv[]) {
     cout << "Starting Linear Search API Server..." << endl;
-    
-    SimpleApiServer server(8080);
-    
+
+    ServerConfig config;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        string text = argv[i + 1];
+        int value = atoi(text.c_str());
+        if(flag == "--port") config.port = value;
+        else if(flag == "--loops") config.event_loops = value;
+        else if(flag == "--max-connections") config.max_connections = value;
+        else if(flag == "--idle-timeout-ms") config.idle_timeout_ms = value;
+        else if(flag == "--workers") config.worker_threads = value;
+        else if(flag == "--queue-capacity") config.queue_capacity = value;
+        else if(flag == "--cache-mb") config.cache_mb = value;
+        else if(flag == "--result-ttl-ms") config.result_ttl_ms = value;
+        else if(flag == "--perf-counters") config.perf_counters = (value != 0);
+        else if(flag == "--log-sample") config.log.sample_every = value;
+        else if(flag == "--log-file") config.log.path = text;
+        else if(flag == "--log-level") {
+            if(!Logger::parseLevel(text, config.log.level)) {
+                cerr << "Unknown log level " << text << ", use debug, info, warn, error or off" << endl;
+            }
+        }
+        else cerr << "Ignoring unknown option " << flag << endl;
+    }
+
+    Logger::start(config.log);
+
     try {
+        SimpleApiServer server(config);
         if(!server.start()) {
             cerr << "Failed to start server. Maybe port is in use?" << endl;
-            cerr << "Trying port 8081..." << endl;
-            
-            SimpleApiServer alt_server(8081);
+            cerr << "Trying port " << config.port + 2 << "..." << endl;
+
+            config.port += 2;
+            SimpleApiServer alt_server(config);
             if(!alt_server.start()) {
                 cerr << "Failed to start on alternative port too." << endl;
+                Logger::stop();
                 return 1;
             }
         }
     }
     catch(const exception& e) {
         cerr << "Fatal error: " << e.what() << endl;
+        Logger::stop();
         return 1;
     }
-    
+
+    Logger::stop();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,169 @@
+#include "simd_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+static size_t findKeyScalar(const uint32_t* keys, size_t n, uint32_t target) {
+    size_t i = 0;
+    while(i < n && keys[i] != target) i++;
+    return i;
+}
+
+#ifdef SIMD_X86
+
+// Each kernel compares four vectors per iteration and only works out which
+// lane matched once the combined mask is non-zero; the tail goes to the
+// scalar loop.
+
+__attribute__((target("sse2")))
+static size_t findKeySse2(const uint32_t* keys, size_t n, uint32_t target) {
+    const __m128i needle = _mm_set1_epi32(static_cast<int>(target));
+    size_t i = 0;
+
+    for(; i + 16 <= n; i += 16) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(keys + i);
+        __m128i c0 = _mm_cmpeq_epi32(_mm_loadu_si128(p), needle);
+        __m128i c1 = _mm_cmpeq_epi32(_mm_loadu_si128(p + 1), needle);
+        __m128i c2 = _mm_cmpeq_epi32(_mm_loadu_si128(p + 2), needle);
+        __m128i c3 = _mm_cmpeq_epi32(_mm_loadu_si128(p + 3), needle);
+        __m128i any = _mm_or_si128(_mm_or_si128(c0, c1), _mm_or_si128(c2, c3));
+        if(_mm_movemask_epi8(any) == 0) continue;
+
+        __m128i cs[4] = {c0, c1, c2, c3};
+        for(int v = 0; v < 4; v++) {
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(cs[v]));
+            if(mask) return i + v * 4 + __builtin_ctz(mask);
+        }
+    }
+
+    return i + findKeyScalar(keys + i, n - i, target);
+}
+
+__attribute__((target("avx2")))
+static size_t findKeyAvx2(const uint32_t* keys, size_t n, uint32_t target) {
+    const __m256i needle = _mm256_set1_epi32(static_cast<int>(target));
+    size_t i = 0;
+
+    for(; i + 32 <= n; i += 32) {
+        const __m256i* p = reinterpret_cast<const __m256i*>(keys + i);
+        __m256i c0 = _mm256_cmpeq_epi32(_mm256_loadu_si256(p), needle);
+        __m256i c1 = _mm256_cmpeq_epi32(_mm256_loadu_si256(p + 1), needle);
+        __m256i c2 = _mm256_cmpeq_epi32(_mm256_loadu_si256(p + 2), needle);
+        __m256i c3 = _mm256_cmpeq_epi32(_mm256_loadu_si256(p + 3), needle);
+        __m256i any = _mm256_or_si256(_mm256_or_si256(c0, c1), _mm256_or_si256(c2, c3));
+        if(_mm256_testz_si256(any, any)) continue;
+
+        __m256i cs[4] = {c0, c1, c2, c3};
+        for(int v = 0; v < 4; v++) {
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(cs[v]));
+            if(mask) return i + v * 8 + __builtin_ctz(mask);
+        }
+    }
+
+    for(; i + 8 <= n; i += 8) {
+        __m256i c = _mm256_cmpeq_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), needle);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(c));
+        if(mask) return i + __builtin_ctz(mask);
+    }
+
+    return i + findKeyScalar(keys + i, n - i, target);
+}
+
+__attribute__((target("avx512f")))
+static size_t findKeyAvx512(const uint32_t* keys, size_t n, uint32_t target) {
+    const __m512i needle = _mm512_set1_epi32(static_cast<int>(target));
+    size_t i = 0;
+
+    for(; i + 64 <= n; i += 64) {
+        __mmask16 m0 = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(keys + i), needle);
+        __mmask16 m1 = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(keys + i + 16), needle);
+        __mmask16 m2 = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(keys + i + 32), needle);
+        __mmask16 m3 = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(keys + i + 48), needle);
+        if((m0 | m1 | m2 | m3) == 0) continue;
+
+        if(m0) return i + __builtin_ctz(m0);
+        if(m1) return i + 16 + __builtin_ctz(m1);
+        if(m2) return i + 32 + __builtin_ctz(m2);
+        return i + 48 + __builtin_ctz(m3);
+    }
+
+    // Masked loads cover the remaining 0-63 keys, so there is no scalar tail.
+    for(; i < n; i += 16) {
+        size_t left = n - i;
+        __mmask16 valid = left >= 16 ? 0xFFFF : static_cast<__mmask16>((1u << left) - 1);
+        __mmask16 m = _mm512_mask_cmpeq_epi32_mask(
+            valid, _mm512_maskz_loadu_epi32(valid, keys + i), needle);
+        if(m) return i + __builtin_ctz(m);
+    }
+
+    return n;
+}
+
+static unsigned long long readXcr0() {
+    unsigned eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+}
+
+SimdLevel detectSimdLevel() {
+    unsigned eax, ebx, ecx, edx;
+    if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return SimdLevel::Scalar;
+
+    bool sse2 = (edx & bit_SSE2) != 0;
+    bool osxsave = (ecx & bit_OSXSAVE) != 0;
+    bool avx = (ecx & bit_AVX) != 0;
+    if(!sse2) return SimdLevel::Scalar;
+    if(!osxsave || !avx) return SimdLevel::SSE2;
+
+    // The OS must save XMM/YMM state (and opmask/ZMM state for AVX-512).
+    unsigned long long xcr0 = readXcr0();
+    bool ymm_enabled = (xcr0 & 0x6) == 0x6;
+    bool zmm_enabled = (xcr0 & 0xE6) == 0xE6;
+    if(!ymm_enabled) return SimdLevel::SSE2;
+
+    if(!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return SimdLevel::SSE2;
+    if((ebx & bit_AVX512F) && zmm_enabled) return SimdLevel::AVX512;
+    if(ebx & bit_AVX2) return SimdLevel::AVX2;
+    return SimdLevel::SSE2;
+}
+
+FindKeyFn findKeyKernel(SimdLevel level) {
+    switch(level) {
+        case SimdLevel::AVX512: return findKeyAvx512;
+        case SimdLevel::AVX2:   return findKeyAvx2;
+        case SimdLevel::SSE2:   return findKeySse2;
+        default:                return findKeyScalar;
+    }
+}
+
+#else
+
+SimdLevel detectSimdLevel() {
+    return SimdLevel::Scalar;
+}
+
+FindKeyFn findKeyKernel(SimdLevel) {
+    return findKeyScalar;
+}
+
+#endif
+
+const char* simdLevelName(SimdLevel level) {
+    switch(level) {
+        case SimdLevel::AVX512: return "avx512";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::SSE2:   return "sse2";
+        default:                return "scalar";
+    }
+}
+
+// Resolved at startup so the first search does not pay for CPUID.
+static const FindKeyFn best_kernel = findKeyKernel(detectSimdLevel());
+
+size_t findKey(const uint32_t* keys, size_t n, uint32_t target) {
+    return best_kernel(keys, n, target);
+}
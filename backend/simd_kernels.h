@@ -0,0 +1,25 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+// Returns the index of the first key equal to target, or n when there is none.
+using FindKeyFn = size_t (*)(const uint32_t* keys, size_t n, uint32_t target);
+
+// Widest instruction set that both the CPU (CPUID) and the OS (XGETBV) support.
+SimdLevel detectSimdLevel();
+const char* simdLevelName(SimdLevel level);
+FindKeyFn findKeyKernel(SimdLevel level);
+
+// Dispatches to the kernel for detectSimdLevel(); detection runs once at startup.
+size_t findKey(const uint32_t* keys, size_t n, uint32_t target);
+
+#endif
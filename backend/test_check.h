@@ -0,0 +1,42 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cstdio>
+
+// Minimal assertions for the *_test.cpp programs. A failed CHECK prints the
+// expression and keeps going; main returns testResult(), which is nonzero
+// when anything failed.
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                                        \
+    do {                                                                                   \
+        if(!(cond)) {                                                                      \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            testFailures()++;                                                              \
+        }                                                                                  \
+    } while(0)
+
+#define CHECK_THROWS(expr)                                                                       \
+    do {                                                                                         \
+        bool threw = false;                                                                      \
+        try {                                                                                    \
+            (void)(expr);                                                                        \
+        } catch(...) {                                                                           \
+            threw = true;                                                                        \
+        }                                                                                        \
+        if(!threw) {                                                                             \
+            std::fprintf(stderr, "%s:%d: CHECK_THROWS failed: %s\n", __FILE__, __LINE__, #expr); \
+            testFailures()++;                                                                    \
+        }                                                                                        \
+    } while(0)
+
+inline int testResult(const char* name) {
+    if(testFailures() == 0) std::printf("%s: all checks passed\n", name);
+    else std::printf("%s: %d checks failed\n", name, testFailures());
+    return testFailures() == 0 ? 0 : 1;
+}
+
+#endif
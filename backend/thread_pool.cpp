@@ -0,0 +1,203 @@
+#include "thread_pool.h"
+#include <iostream>
+#include <algorithm>
+#include <exception>
+
+using namespace std;
+
+// The pool and index of the worker running on this thread; nullptr and -1
+// for threads outside any pool. A worker may submit to another pool, whose
+// queues its index does not refer to.
+static thread_local const WorkStealingPool* current_pool = nullptr;
+static thread_local int current_worker = -1;
+
+WorkStealingPool::WorkStealingPool(int threads, int queue_capacity)
+    : capacity(queue_capacity > 0 ? queue_capacity : 1),
+      queued(0), active(0), completed(0), rejected(0), steals(0), next_queue(0),
+      stopping(false) {
+    if(threads <= 0) threads = 1;
+
+    for(int i = 0; i < threads; i++) {
+        queues.push_back(make_unique<WorkerQueue>());
+    }
+    for(int i = 0; i < threads; i++) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    shutdown();
+}
+
+bool WorkStealingPool::trySubmit(Task task) {
+    if(queued.fetch_add(1) >= capacity) {
+        queued--;
+        rejected++;
+        return false;
+    }
+
+    int id = current_pool == this ? current_worker
+                                  : static_cast<int>(next_queue++ % queues.size());
+    {
+        lock_guard<mutex> lock(queues[id]->mutex);
+        queues[id]->tasks.push_back(move(task));
+    }
+    {
+        lock_guard<mutex> lock(sleep_mutex);
+    }
+    wake.notify_one();
+    return true;
+}
+
+void WorkStealingPool::shutdown() {
+    {
+        lock_guard<mutex> lock(sleep_mutex);
+        if(stopping) return;
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for(auto& t : workers) {
+        if(t.joinable()) t.join();
+    }
+    workers.clear();
+}
+
+PoolStats WorkStealingPool::stats() const {
+    PoolStats s;
+    s.threads = static_cast<int>(queues.size());
+    s.queue_capacity = capacity;
+    s.queue_depth = queued.load();
+    s.active = active.load();
+    s.completed = completed.load();
+    s.rejected = rejected.load();
+    s.steals = steals.load();
+    return s;
+}
+
+bool WorkStealingPool::popTask(int id, Task& task) {
+    {
+        WorkerQueue& own = *queues[id];
+        lock_guard<mutex> lock(own.mutex);
+        if(!own.tasks.empty()) {
+            task = move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    int n = static_cast<int>(queues.size());
+    for(int k = 1; k < n; k++) {
+        WorkerQueue& victim = *queues[(id + k) % n];
+        lock_guard<mutex> lock(victim.mutex);
+        if(!victim.tasks.empty()) {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int id) {
+    current_pool = this;
+    current_worker = id;
+
+    while(true) {
+        Task task;
+        if(popTask(id, task)) {
+            queued--;
+            active++;
+            try {
+                task();
+            } catch(const exception& e) {
+                cerr << "[POOL] task failed: " << e.what() << endl;
+            }
+            active--;
+            completed++;
+            continue;
+        }
+
+        unique_lock<mutex> lock(sleep_mutex);
+        if(stopping) return;
+        wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+        if(stopping) return;
+    }
+}
+
+// ==================== FORK-JOIN ====================
+
+namespace {
+
+// Shared with the helper tasks, which may start after the caller has
+// returned; they then find no part left and never touch body.
+struct ForkJoin {
+    const function<void(size_t)>* body;
+    size_t parts;
+    atomic<size_t> next{0};
+    atomic<size_t> done{0};
+    mutex done_mutex;
+    condition_variable all_done;
+    exception_ptr error;
+
+    void runParts() {
+        size_t finished = 0;
+        for(size_t i = next.fetch_add(1); i < parts; i = next.fetch_add(1)) {
+            try {
+                (*body)(i);
+            } catch(...) {
+                lock_guard<mutex> lock(done_mutex);
+                if(!error) error = current_exception();
+            }
+            finished++;
+        }
+        if(finished > 0 && done.fetch_add(finished) + finished == parts) {
+            lock_guard<mutex> lock(done_mutex);
+            all_done.notify_all();
+        }
+    }
+};
+
+atomic<int> parallelism_override(0);
+
+int helperThreads() {
+    return static_cast<int>(thread::hardware_concurrency()) - 1;
+}
+
+WorkStealingPool& helperPool() {
+    static WorkStealingPool pool(max(1, helperThreads()), 16 * max(1, helperThreads()));
+    return pool;
+}
+
+} // namespace
+
+void parallelFor(size_t parts, const function<void(size_t)>& body) {
+    int helpers = static_cast<int>(min<long long>(parallelism() - 1, static_cast<long long>(parts) - 1));
+    if(helpers <= 0) {
+        for(size_t i = 0; i < parts; i++) body(i);
+        return;
+    }
+
+    auto job = make_shared<ForkJoin>();
+    job->body = &body;
+    job->parts = parts;
+    WorkStealingPool& pool = helperPool();
+    for(int h = 0; h < helpers; h++) {
+        if(!pool.trySubmit([job]() { job->runParts(); })) break;
+    }
+    job->runParts();
+
+    unique_lock<mutex> lock(job->done_mutex);
+    job->all_done.wait(lock, [&job]() { return job->done.load() == job->parts; });
+    if(job->error) rethrow_exception(job->error);
+}
+
+int parallelism() {
+    int threads = parallelism_override.load(memory_order_relaxed);
+    return threads > 0 ? threads : max(1, static_cast<int>(thread::hardware_concurrency()));
+}
+
+void setParallelism(int threads) {
+    parallelism_override.store(max(0, threads), memory_order_relaxed);
+}
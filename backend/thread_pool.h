@@ -0,0 +1,78 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+struct PoolStats {
+    int threads;
+    long long queue_capacity;
+    long long queue_depth;
+    long long active;
+    long long completed;
+    long long rejected;
+    long long steals;
+};
+
+// Fixed-size pool where every worker owns a deque. Workers pop their own work
+// LIFO and steal FIFO from the others when idle. Admission is bounded: once
+// queue_capacity tasks are waiting, trySubmit() refuses new work instead of
+// letting the backlog grow.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    WorkStealingPool(int threads, int queue_capacity);
+    ~WorkStealingPool();
+
+    bool trySubmit(Task task);
+    void shutdown();
+    PoolStats stats() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(int id);
+    bool popTask(int id, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    long long capacity;
+
+    std::atomic<long long> queued;
+    std::atomic<long long> active;
+    std::atomic<long long> completed;
+    std::atomic<long long> rejected;
+    std::atomic<long long> steals;
+    std::atomic<unsigned> next_queue;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping;
+};
+
+// Fork-join for data-parallel loops inside a single request. Runs body(0) ..
+// body(parts - 1) on the calling thread and a process-wide helper pool of one
+// thread per core less one, and returns once every part has run. Helpers only
+// take parts nobody has started yet, so when they are busy with other callers
+// the caller runs the rest itself: the thread count stays fixed however many
+// requests fork at once, and callers never wait for a queued task. The first
+// exception thrown by a part is rethrown to the caller.
+void parallelFor(size_t parts, const std::function<void(size_t)>& body);
+
+// Threads a data-parallel loop may use, the caller included: one per core
+// unless set otherwise. setParallelism(0) goes back to one per core; results
+// must not depend on it.
+int parallelism();
+void setParallelism(int threads);
+
+#endif
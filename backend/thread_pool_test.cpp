@@ -0,0 +1,86 @@
+#include "thread_pool.h"
+#include "response_writer.h"
+#include "test_check.h"
+#include <future>
+#include <chrono>
+#include <stdexcept>
+
+using namespace std;
+using namespace chrono;
+
+static bool contains(const string& text, const string& part) {
+    return text.find(part) != string::npos;
+}
+
+template<typename Pred>
+static bool waitFor(Pred pred) {
+    auto deadline = steady_clock::now() + seconds(5);
+    while(!pred() && steady_clock::now() < deadline) this_thread::sleep_for(milliseconds(1));
+    return pred();
+}
+
+// A handler that throws on the pool still produces a complete 500 response,
+// and the worker goes on to run the next task.
+static void testThrowingTaskAnswers500() {
+    WorkStealingPool pool(1, 4);
+    ResponseBuffer out;
+    string error;
+    promise<bool> answered;
+
+    CHECK(pool.trySubmit([&]() {
+        bool ok = answerOrFail(out, error, [](ResponseBuffer& r) {
+            r.body = "{\"partial\":";
+            throw runtime_error("dataset build failed");
+        });
+        out.writeHead("");
+        answered.set_value(ok);
+    }));
+    future<bool> done = answered.get_future();
+    CHECK(done.wait_for(seconds(5)) == future_status::ready);
+    CHECK(!done.get());
+    CHECK(error == "dataset build failed");
+    CHECK(string(out.status) == "500 Internal Server Error");
+    CHECK(out.body == "{\"error\":\"Internal server error\"}");
+    CHECK(out.head.rfind("HTTP/1.1 500 Internal Server Error\r\n", 0) == 0);
+    CHECK(contains(out.head, "Content-Length: 33\r\n"));
+
+    ResponseBuffer other;
+    CHECK(!answerOrFail(other, error, [](ResponseBuffer&) { throw 42; }));
+    CHECK(string(other.status) == "500 Internal Server Error");
+
+    promise<void> next;
+    CHECK(pool.trySubmit([&]() { next.set_value(); }));
+    CHECK(next.get_future().wait_for(seconds(5)) == future_status::ready);
+}
+
+// Once queue_capacity tasks are waiting, trySubmit refuses, and the request
+// is answered with a 503 that tells the client when to retry.
+static void testFullQueueAnswers503() {
+    WorkStealingPool pool(1, 2);
+    promise<void> gate;
+    shared_future<void> open = gate.get_future().share();
+
+    CHECK(pool.trySubmit([open]() { open.wait(); }));
+    CHECK(waitFor([&]() { return pool.stats().active == 1; }));
+    CHECK(pool.trySubmit([open]() { open.wait(); }));
+    CHECK(pool.trySubmit([open]() { open.wait(); }));
+    CHECK(!pool.trySubmit([]() {}));
+    CHECK(pool.stats().rejected == 1);
+
+    ResponseBuffer out;
+    writeBusyResponse(out);
+    out.writeHead("");
+    CHECK(out.head.rfind("HTTP/1.1 503 Service Unavailable\r\n", 0) == 0);
+    CHECK(contains(out.head, "Retry-After: 1\r\n"));
+    CHECK(out.body == "{\"error\":\"Server busy, retry later\"}");
+
+    gate.set_value();
+    CHECK(waitFor([&]() { return pool.stats().completed == 3; }));
+    CHECK(pool.trySubmit([]() {}));
+}
+
+int main() {
+    testThrowingTaskAnswers500();
+    testFullQueueAnswers503();
+    return testResult("thread_pool_test");
+}